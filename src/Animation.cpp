@@ -17,25 +17,45 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 ******************************************************************************/
 
 #include "Animation.h"
+#include "Flic.h"
 #include "SoundCache.h"
 
+static TextureUpload::Handle load_flic(const std::string &filename) {
+    return TextureUpload::Load([filename]() {
+        return Flic(filename).takeImages();
+    });
+}
+
 
-Animation::Animation(const std::string &flic_filename, const std::string &sound_filename) : flic(flic_filename), sound(SoundCache::Load(sound_filename)) {
+Animation::Animation(const std::string &flic_filename, const std::string &sound_filename) : flicFilename(flic_filename), sound(SoundCache::Load(sound_filename)) {
 }
 
-Animation::Animation(const std::string &flic_filename) : flic(flic_filename), sound(nullptr) {
+Animation::Animation(const std::string &flic_filename) : flicFilename(flic_filename), sound(nullptr) {
 
 }
 
+void Animation::load() {
+    if (!frames.isLoaded())
+        frames = load_flic(flicFilename);
+}
+
 bool Animation::play(const int scale) {
+    load();
+
+    if (!frames.isReady()) {
+        frames.get().Draw(Vector2(0, 0), 0.0f, scale);
+        return false;
+    }
+
     if (frame == 0 && sound) {
         sound->Play();
     }
 
     size_t animation_frame = frame / 6; 
 
-    if (animation_frame >= flic.getFrameCount()) {
+    if (animation_frame >= frames.getCount()) {
         frame = 0;
+        release();
         return true;
     }
 
@@ -45,13 +65,18 @@ bool Animation::play(const int scale) {
         0.0f
     );
 
-    flic.getTexture(animation_frame).Draw(Vector2(0, 0), 0.0f, scale); 
+    frames.get(animation_frame).Draw(Vector2(0, 0), 0.0f, scale); 
 
     frame += 1;
 
     return false;
 }
 
+void Animation::release() {
+    frames = TextureUpload::Handle();
+    frame = 0;
+}
+
 Animation::~Animation() {
 
 }
@@ -21,22 +21,32 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include <cstdint>
 #include <deque>
+#include <string>
 
 #include <raylib-cpp.hpp>
 
-#include "Flic.h"
+#include "TextureUpload.h"
 
 class Animation {
     size_t frame = 0;
 
-    Flic flic;
+    // decoded from the flic on the upload worker, requested by load() or the first play
+    std::string flicFilename;
+    TextureUpload::Handle frames;
     raylib::Sound *sound;
 public:
     Animation(const std::string &flic_filename, const std::string &sound_filename);
     Animation(const std::string &flic_filename);
 
+    // requests the frames ahead of play(), does nothing if they are already requested
+    void load();
+
+    // returns true once the last frame has been shown, draws the blank placeholder and does not start until the upload is ready
     bool play(const int scale);
 
+    // drops the frames, their textures are unloaded once no upload or handle refers to them
+    void release();
+
     ~Animation();
 };
 
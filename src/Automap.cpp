@@ -0,0 +1,112 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+
+#include "Automap.h"
+#include "World.h"
+#include "Entity.h"
+
+static raylib::Color segment_colour(SegmentType type) {
+    switch (type) {
+        case SegmentType::Unknown:
+            return raylib::GRAY;
+        case SegmentType::Wall:
+            return raylib::YELLOW;
+        case SegmentType::Door:
+            return raylib::BLUE;
+        case SegmentType::Monster:
+            return raylib::RED;
+        case SegmentType::Item:
+            return raylib::WHITE;
+        case SegmentType::Prop:
+            return raylib::GREEN;
+        case SegmentType::Trap:
+            return raylib::PURPLE;
+    }
+
+    return raylib::GRAY;
+}
+
+void Automap::update(World *world, const Map *new_map, int new_scale) {
+    if (!dirty && layer && map == new_map && scale == new_scale)
+        return;
+
+    render(world, new_map, new_scale);
+
+    map = new_map;
+    scale = new_scale;
+    dirty = false;
+}
+
+raylib::Vector2 Automap::toLayer(const raylib::Vector2 &position) const {
+    // one line width of margin so walls on the map edge are not clipped
+    return position * MapScale * scale + raylib::Vector2(scale, scale);
+}
+
+void Automap::render(World *world, const Map *new_map, int new_scale) {
+    scale = new_scale;
+
+    int width = (new_map->getWidth() * MapScale + 2) * scale;
+    int height = (new_map->getHeight() * MapScale + 2) * scale;
+
+    if (layer && (layer->texture.width != width || layer->texture.height != height)) {
+        UnloadRenderTexture(*layer);
+        layer = std::nullopt;
+    }
+
+    if (!layer)
+        layer = LoadRenderTexture(width, height);
+
+    BeginTextureMode(*layer);
+    {
+        ClearBackground(BLANK);
+
+        for (const auto &segment : new_map->getSegments()) {
+            Entity *entity = world->getEntity(segment.id);
+
+            if (!entity)
+                continue;
+
+            DrawLineEx(toLayer(raylib::Vector2(segment.x1, segment.y1)), toLayer(raylib::Vector2(segment.x2, segment.y2)), scale, segment_colour(entity->getType()));
+        }
+    }
+    EndTextureMode();
+}
+
+raylib::Rectangle Automap::draw(const raylib::Rectangle &area) const {
+    if (!layer)
+        return raylib::Rectangle(area.x, area.y, 0.0f, 0.0f);
+
+    float width = layer->texture.width;
+    float height = layer->texture.height;
+    float factor = std::min(1.0f, std::min(area.width / width, area.height / height));
+
+    // render textures are stored upside down
+    raylib::Rectangle source(0.0f, 0.0f, width, -height);
+    raylib::Rectangle dest(area.x + (area.width - width * factor) / 2.0f, area.y + (area.height - height * factor) / 2.0f, width * factor, height * factor);
+
+    DrawTexturePro(layer->texture, source, dest, Vector2(0.0f, 0.0f), 0.0f, WHITE);
+
+    return dest;
+}
+
+Automap::~Automap() {
+    if (layer)
+        UnloadRenderTexture(*layer);
+}
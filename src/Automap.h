@@ -0,0 +1,82 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef AUTOMAP_H
+#define AUTOMAP_H
+
+#include <cstdint>
+#include <optional>
+
+#include <raylib-cpp.hpp>
+
+#include "Map.h"
+
+class World;
+
+// Map screen segments drawn once into a texture and reused until the level or scale changes
+class Automap {
+    std::optional<RenderTexture2D> layer;
+
+    const Map *map = nullptr;
+    int scale = 0;
+    bool dirty = true;
+    bool overlay = false;
+
+    void render(World *world, const Map *map, int scale);
+public:
+    static constexpr float MapScale = 0.4f;
+
+    Automap() {
+    }
+
+    Automap(const Automap &) = delete;
+    Automap &operator=(const Automap &) = delete;
+
+    void invalidate() {
+        dirty = true;
+    }
+
+    bool isOverlay() const {
+        return overlay;
+    }
+
+    void setOverlay(bool new_overlay) {
+        overlay = new_overlay;
+    }
+
+    // renders into a texture, so call it before Screen::BeginFrame
+    void update(World *world, const Map *map, int scale);
+
+    // world position to pixels inside the layer
+    raylib::Vector2 toLayer(const raylib::Vector2 &position) const;
+
+    // fitted and centred inside area, never enlarged, returns where the layer landed
+    raylib::Rectangle draw(const raylib::Rectangle &area) const;
+
+    int getWidth() const {
+        return layer ? layer->texture.width : 0;
+    }
+
+    int getHeight() const {
+        return layer ? layer->texture.height : 0;
+    }
+
+    ~Automap();
+};
+
+#endif //AUTOMAP_H
@@ -0,0 +1,202 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+
+#include "BillboardRenderer.h"
+
+static const char *vertex_shader = R"(
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+
+// Input instance attributes
+in vec4 instancePosition;
+in vec4 instanceUV;
+in vec2 instanceAnimation;
+
+// Input uniform values
+uniform mat4 mvp;
+uniform mat4 matView;
+uniform int frameCounter;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out vec3 fragPosition;
+
+void main()
+{
+    // camera right from the view matrix and world up, sprites stay upright like DrawBillboard
+    vec3 right = vec3(matView[0][0], matView[1][0], matView[2][0]);
+    vec3 up = vec3(0.0, 1.0, 0.0);
+
+    vec3 position = instancePosition.xyz + (right*vertexPosition.x + up*vertexPosition.y)*instancePosition.w;
+
+    // step through consecutive 64x64 slots of the 2048x2048 page, same as the animated wall shader
+    int frame = (frameCounter / int(instanceAnimation.y)) % int(instanceAnimation.x);
+
+    ivec2 cel = ivec2(floor(instanceUV.xy*32.0));
+    int slot = cel.y*32 + cel.x + frame;
+
+    vec2 origin = instanceUV.xy + vec2(ivec2(slot % 32, slot / 32) - cel)/32.0;
+
+    fragTexCoord = origin + vertexTexCoord*instanceUV.zw;
+    fragColor = vec4(1.0);
+    fragPosition = position;
+    gl_Position = mvp*vec4(position, 1.0);
+})";
+
+static const int quad_vertices = 6;
+static const int instance_floats = 10;
+static const int instance_stride = instance_floats * sizeof(float);
+
+BillboardRenderer::BillboardRenderer(const char *fragment_shader) {
+    shader = raylib::ShaderUnmanaged::LoadFromMemory(vertex_shader, fragment_shader);
+
+    positionLocation = shader.GetLocationAttrib("instancePosition");
+    uvLocation = shader.GetLocationAttrib("instanceUV");
+    animationLocation = shader.GetLocationAttrib("instanceAnimation");
+    frameCounterLocation = shader.GetLocation("frameCounter");
+
+    // unit quad in the same corner order as DrawBillboardPro, x y offset then u v
+    const float quad[quad_vertices][5] = {
+        {-0.5f, -0.5f, 0.0f, 0.0f, 1.0f},
+        {0.5f, -0.5f, 0.0f, 1.0f, 1.0f},
+        {0.5f, 0.5f, 0.0f, 1.0f, 0.0f},
+        {0.5f, 0.5f, 0.0f, 1.0f, 0.0f},
+        {-0.5f, 0.5f, 0.0f, 0.0f, 0.0f},
+        {-0.5f, -0.5f, 0.0f, 0.0f, 1.0f},
+    };
+
+    vao = rlLoadVertexArray();
+    rlEnableVertexArray(vao);
+
+    quadBuffer = rlLoadVertexBuffer(quad, sizeof(quad), false);
+
+    rlSetVertexAttribute(shader.locs[SHADER_LOC_VERTEX_POSITION], 3, RL_FLOAT, false, sizeof(quad[0]), 0);
+    rlEnableVertexAttribute(shader.locs[SHADER_LOC_VERTEX_POSITION]);
+    rlSetVertexAttribute(shader.locs[SHADER_LOC_VERTEX_TEXCOORD01], 2, RL_FLOAT, false, sizeof(quad[0]), 3 * sizeof(float));
+    rlEnableVertexAttribute(shader.locs[SHADER_LOC_VERTEX_TEXCOORD01]);
+
+    rlDisableVertexArray();
+
+    reserve(256);
+}
+
+void BillboardRenderer::reserve(size_t count) {
+    if (count <= capacity)
+        return;
+
+    capacity = std::max(count, capacity * 2);
+
+    rlEnableVertexArray(vao);
+
+    if (instanceBuffer)
+        rlUnloadVertexBuffer(instanceBuffer);
+
+    instanceBuffer = rlLoadVertexBuffer(nullptr, capacity * instance_stride, true);
+
+    rlSetVertexAttribute(positionLocation, 4, RL_FLOAT, false, instance_stride, 0);
+    rlEnableVertexAttribute(positionLocation);
+    rlSetVertexAttributeDivisor(positionLocation, 1);
+
+    rlSetVertexAttribute(uvLocation, 4, RL_FLOAT, false, instance_stride, 4 * sizeof(float));
+    rlEnableVertexAttribute(uvLocation);
+    rlSetVertexAttributeDivisor(uvLocation, 1);
+
+    rlSetVertexAttribute(animationLocation, 2, RL_FLOAT, false, instance_stride, 8 * sizeof(float));
+    rlEnableVertexAttribute(animationLocation);
+    rlSetVertexAttributeDivisor(animationLocation, 1);
+
+    rlDisableVertexArray();
+}
+
+void BillboardRenderer::add(const raylib::Vector3 &position, float size, const CelHandle &texture, const CelAnimation &animation) {
+    instances.push_back(Instance{texture.atlas.id, {position.x, position.y, position.z, size}, {texture.uv.x, texture.uv.y, texture.uv.width, texture.uv.height}, {(float)animation.frames, (float)animation.frameRate}});
+}
+
+void BillboardRenderer::draw(uint64_t frame_count) {
+    drawCalls = 0;
+
+    if (instances.empty())
+        return;
+
+    std::stable_sort(std::begin(instances), std::end(instances), [](const Instance &l, const Instance &r) {
+        return l.texture < r.texture;
+    });
+
+    upload.clear();
+
+    for (const auto &instance : instances) {
+        upload.insert(std::end(upload), std::begin(instance.position), std::end(instance.position));
+        upload.insert(std::end(upload), std::begin(instance.uv), std::end(instance.uv));
+        upload.insert(std::end(upload), std::begin(instance.animation), std::end(instance.animation));
+    }
+
+    // one upload per frame for every sprite on screen
+    reserve(instances.size());
+    rlUpdateVertexBuffer(instanceBuffer, upload.data(), upload.size() * sizeof(float), 0);
+
+    rlDrawRenderBatchActive();
+
+    Matrix view = rlGetMatrixModelview();
+    Matrix mvp = MatrixMultiply(view, rlGetMatrixProjection());
+
+    const float colour[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    const int texture_slot = 0;
+    const int frame_counter = frame_count & 0x7FFFFFFF;
+
+    rlEnableShader(shader.id);
+    rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MVP], mvp);
+    rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_VIEW], view);
+    rlSetUniform(shader.locs[SHADER_LOC_COLOR_DIFFUSE], colour, RL_SHADER_UNIFORM_VEC4, 1);
+    rlSetUniform(shader.locs[SHADER_LOC_MAP_DIFFUSE], &texture_slot, RL_SHADER_UNIFORM_INT, 1);
+    rlSetUniform(frameCounterLocation, &frame_counter, RL_SHADER_UNIFORM_INT, 1);
+
+    rlActiveTextureSlot(texture_slot);
+    rlEnableVertexArray(vao);
+    rlEnableVertexBuffer(instanceBuffer);
+
+    for (size_t i = 0; i < instances.size();) {
+        size_t first = i;
+        unsigned int texture = instances[i].texture;
+
+        while (i < instances.size() && instances[i].texture == texture) {
+            i++;
+        }
+
+        // GL 3.3 has no base instance, so point the instance attributes at this page's run instead
+        rlSetVertexAttribute(positionLocation, 4, RL_FLOAT, false, instance_stride, first * instance_stride);
+        rlSetVertexAttribute(uvLocation, 4, RL_FLOAT, false, instance_stride, first * instance_stride + 4 * sizeof(float));
+        rlSetVertexAttribute(animationLocation, 2, RL_FLOAT, false, instance_stride, first * instance_stride + 8 * sizeof(float));
+
+        rlEnableTexture(texture);
+        rlDrawVertexArrayInstanced(0, quad_vertices, i - first);
+        drawCalls++;
+    }
+
+    rlDisableTexture();
+    rlDisableVertexBuffer();
+    rlDisableVertexArray();
+    rlDisableShader();
+
+    instances.clear();
+}
@@ -0,0 +1,82 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef BILLBOARDRENDERER_H
+#define BILLBOARDRENDERER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+#include "CelAtlas.h"
+
+// Camera facing sprites drawn with one instanced call per atlas page
+class BillboardRenderer {
+    struct Instance {
+        unsigned int texture;
+        // xyz centre, w size
+        float position[4];
+        // u, v, width, height inside the atlas page
+        float uv[4];
+        // frame count and rate, 1 1 for still sprites
+        float animation[2];
+    };
+
+    std::vector<Instance> instances;
+    std::vector<float> upload;
+
+    raylib::ShaderUnmanaged shader;
+    int positionLocation;
+    int uvLocation;
+    int animationLocation;
+    int frameCounterLocation;
+
+    unsigned int vao = 0;
+    unsigned int quadBuffer = 0;
+    unsigned int instanceBuffer = 0;
+    size_t capacity = 0;
+
+    size_t drawCalls = 0;
+
+    void reserve(size_t count);
+public:
+    BillboardRenderer(const char *fragment_shader);
+
+    BillboardRenderer(const BillboardRenderer &) = delete;
+    BillboardRenderer &operator=(const BillboardRenderer &) = delete;
+
+    void add(const raylib::Vector3 &position, float size, const CelHandle &texture, const CelAnimation &animation);
+
+    // must be called inside camera->BeginMode(), clears the instances
+    void draw(uint64_t frame_count);
+
+    size_t getCount() const {
+        return instances.size();
+    }
+
+    size_t getDrawCalls() const {
+        return drawCalls;
+    }
+
+    const raylib::ShaderUnmanaged &getShader() const {
+        return shader;
+    }
+};
+
+#endif //BILLBOARDRENDERER_H
@@ -0,0 +1,474 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Capture.h"
+#include "GLExtensions.h"
+
+// a Slot is Free, Reading while its fence is pending, then Encoding until the worker has copied the pixels out
+struct Slot {
+    enum State {
+        Free,
+        Reading,
+        Encoding,
+    };
+
+    unsigned int buffer = 0;
+    uint8_t *mapped = nullptr;
+    void *fence = nullptr;
+    State state = Free;
+
+    int width = 0;
+    int height = 0;
+    bool screenshot = false;
+    bool recording = false;
+
+    std::atomic<bool> busy = false;
+};
+
+struct Task {
+    enum Type {
+        Open,
+        Frame,
+        Close,
+    };
+
+    Type type;
+    Slot *slot;
+    const uint8_t *pixels;
+    std::string filename;
+    int frameRate;
+};
+
+class Encoder {
+    std::vector<uint8_t> rgba;
+    std::vector<uint8_t> yuv;
+    std::ofstream video;
+    int videoWidth = 0;
+    int videoHeight = 0;
+    std::string videoFilename;
+    int frameRate = 60;
+
+    // GL rows run bottom up
+    void copy(const Slot &slot, const uint8_t *pixels) {
+        const size_t row_bytes = slot.width * 4;
+        rgba.resize(row_bytes * slot.height);
+
+        for (int y = 0; y < slot.height; y++) {
+            std::memcpy(rgba.data() + y * row_bytes, pixels + (slot.height - 1 - y) * row_bytes, row_bytes);
+        }
+    }
+
+    void writePng(const std::string &filename, int width, int height) {
+        for (size_t i = 3; i < rgba.size(); i += 4) {
+            rgba[i] = 0xFF;
+        }
+
+        // plain Image, the pixels still belong to rgba
+        const Image image = {rgba.data(), width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+
+        if (!ExportImage(image, filename.c_str()))
+            std::cerr << "Could not write " << filename << std::endl;
+    }
+
+    // 4:2:0 with full range BT.601, odd widths and heights lose their last column or row
+    void writeVideoFrame(int width, int height) {
+        const int w = videoWidth;
+        const int h = videoHeight;
+        const size_t row_bytes = width * 4;
+
+        yuv.resize(w * h + (w / 2) * (h / 2) * 2);
+        uint8_t *luma = yuv.data();
+        uint8_t *cb = luma + w * h;
+        uint8_t *cr = cb + (w / 2) * (h / 2);
+
+        for (int y = 0; y < h; y++) {
+            const uint8_t *row = rgba.data() + y * row_bytes;
+
+            for (int x = 0; x < w; x++) {
+                const uint8_t *p = row + x * 4;
+                luma[y * w + x] = (uint8_t)std::clamp(0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2] + 0.5f, 0.0f, 255.0f);
+            }
+        }
+
+        for (int y = 0; y < h / 2; y++) {
+            for (int x = 0; x < w / 2; x++) {
+                float r = 0.0f, g = 0.0f, b = 0.0f;
+
+                for (int i = 0; i < 4; i++) {
+                    const uint8_t *p = rgba.data() + (y * 2 + i / 2) * row_bytes + (x * 2 + i % 2) * 4;
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+
+                r /= 4.0f;
+                g /= 4.0f;
+                b /= 4.0f;
+
+                cb[y * (w / 2) + x] = (uint8_t)std::clamp(128.0f - 0.168736f * r - 0.331264f * g + 0.5f * b + 0.5f, 0.0f, 255.0f);
+                cr[y * (w / 2) + x] = (uint8_t)std::clamp(128.0f + 0.5f * r - 0.418688f * g - 0.081312f * b + 0.5f, 0.0f, 255.0f);
+            }
+        }
+
+        video << "FRAME\n";
+        video.write((const char *)yuv.data(), yuv.size());
+    }
+public:
+    void run(const Task &task) {
+        switch (task.type) {
+            case Task::Open:
+                videoFilename = task.filename;
+                frameRate = task.frameRate;
+                videoWidth = 0;
+                break;
+            case Task::Frame: {
+                Slot *slot = task.slot;
+                int width = slot->width;
+                int height = slot->height;
+                bool screenshot = slot->screenshot;
+                bool recording = slot->recording;
+
+                copy(*slot, task.pixels);
+
+                // the pixel buffer can go back to the main thread before any encoding
+                slot->busy = false;
+
+                if (screenshot)
+                    writePng(task.filename, width, height);
+
+                if (recording) {
+                    if (!videoWidth) {
+                        videoWidth = width & ~1;
+                        videoHeight = height & ~1;
+
+                        video.open(videoFilename, std::ios::binary|std::ios::out);
+
+                        // the samples are full range, readers assume limited range without the tag
+                        video << "YUV4MPEG2 W" << videoWidth << " H" << videoHeight << " F" << frameRate << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+                    }
+
+                    if (width >= videoWidth && height >= videoHeight)
+                        writeVideoFrame(width, height);
+                }
+
+                break;
+            }
+            case Task::Close:
+                if (video.is_open()) {
+                    video.close();
+                    std::cout << "Recorded " << videoFilename << std::endl;
+                }
+
+                videoWidth = 0;
+                break;
+        }
+    }
+};
+
+class Worker {
+public:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Task> tasks;
+    bool stop = false;
+    Encoder encoder;
+
+    // last, so everything above exists before the thread starts
+    std::thread thread;
+
+    Worker() : thread([this]() { run(); }) {
+    }
+
+    void push(const Task &task) {
+        {
+            std::lock_guard lock(mutex);
+            tasks.push_back(task);
+        }
+
+        wake.notify_one();
+    }
+
+    void run() {
+        std::unique_lock lock(mutex);
+
+        while (true) {
+            wake.wait(lock, [this]() { return stop || !tasks.empty(); });
+
+            // finish what was queued so a recording is never cut short
+            if (tasks.empty())
+                return;
+
+            Task task = std::move(tasks.front());
+            tasks.pop_front();
+
+            lock.unlock();
+            encoder.run(task);
+            lock.lock();
+        }
+    }
+
+    ~Worker() {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+
+        wake.notify_one();
+        thread.join();
+    }
+};
+
+static std::array<Slot, Capture::Slots> slots;
+static bool persistent = false;
+static size_t capacity = 0;
+
+// slot indices in the order their reads were issued, -1 marks the end of a recording
+static std::deque<int> in_flight;
+static uint64_t issued = 0;
+
+static std::string directory = ".";
+static bool screenshot_requested = false;
+static bool recording = false;
+static uint32_t recording_frames = 0;
+static uint32_t recorded_frames = 0;
+static int recording_width = 0;
+static int recording_height = 0;
+static uint32_t dropped_frames = 0;
+
+static Worker &worker() {
+    static Worker worker;
+    return worker;
+}
+
+static std::string timestamp() {
+    std::time_t now = std::time(nullptr);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y%m%d-%H%M%S", std::localtime(&now));
+
+    return buffer;
+}
+
+static void allocate(size_t size) {
+    for (auto &slot : slots) {
+        if (slot.buffer) {
+            if (slot.mapped) {
+                glad_glBindBuffer(gl_pixel_pack_buffer, slot.buffer);
+                glad_glUnmapBuffer(gl_pixel_pack_buffer);
+            }
+
+            glad_glDeleteBuffers(1, &slot.buffer);
+        }
+
+        slot.buffer = 0;
+        slot.mapped = nullptr;
+
+        glad_glGenBuffers(1, &slot.buffer);
+        glad_glBindBuffer(gl_pixel_pack_buffer, slot.buffer);
+
+        // persistently mapped when possible, the worker then reads straight from the buffer
+        if (glad_glBufferStorage) {
+            const unsigned int flags = gl_map_read_bit | gl_map_persistent_bit | gl_map_coherent_bit;
+
+            glad_glBufferStorage(gl_pixel_pack_buffer, size, nullptr, flags);
+            slot.mapped = (uint8_t *)glad_glMapBufferRange(gl_pixel_pack_buffer, 0, size, flags);
+        }
+
+        if (!slot.mapped)
+            glad_glBufferData(gl_pixel_pack_buffer, size, nullptr, gl_stream_read);
+    }
+
+    glad_glBindBuffer(gl_pixel_pack_buffer, 0);
+
+    persistent = slots[0].mapped;
+    capacity = size;
+}
+
+// hands finished reads to the worker in issue order and frees slots it is done with, never waits on the GPU
+static void collect() {
+    while (!in_flight.empty()) {
+        int index = in_flight.front();
+
+        if (index < 0) {
+            worker().push(Task(Task::Close, nullptr, nullptr, "", 0));
+            in_flight.pop_front();
+            continue;
+        }
+
+        auto &slot = slots[index];
+
+        if (glad_glClientWaitSync(slot.fence, 0, 0) == gl_timeout_expired)
+            break;
+
+        glad_glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        const uint8_t *pixels = slot.mapped;
+
+        if (!pixels) {
+            glad_glBindBuffer(gl_pixel_pack_buffer, slot.buffer);
+            pixels = (const uint8_t *)glad_glMapBufferRange(gl_pixel_pack_buffer, 0, slot.width * slot.height * 4, gl_map_read_bit);
+            glad_glBindBuffer(gl_pixel_pack_buffer, 0);
+        }
+
+        slot.state = Slot::Encoding;
+        slot.busy = true;
+
+        std::string filename = slot.screenshot ? directory + "/screenshot-" + timestamp() + "-" + std::to_string(index) + ".png" : "";
+        worker().push(Task(Task::Frame, &slot, pixels, filename, 0));
+
+        in_flight.pop_front();
+    }
+
+    for (auto &slot : slots) {
+        if (slot.state != Slot::Encoding || slot.busy)
+            continue;
+
+        if (!persistent) {
+            glad_glBindBuffer(gl_pixel_pack_buffer, slot.buffer);
+            glad_glUnmapBuffer(gl_pixel_pack_buffer);
+            glad_glBindBuffer(gl_pixel_pack_buffer, 0);
+        }
+
+        slot.state = Slot::Free;
+    }
+}
+
+void Capture::SetDirectory(const std::string &new_directory) {
+    directory = new_directory;
+}
+
+void Capture::Screenshot() {
+    screenshot_requested = true;
+}
+
+void Capture::StartRecording(uint32_t frames, int frame_rate) {
+    if (recording)
+        return;
+
+    recording = true;
+    recording_frames = frames;
+    recorded_frames = 0;
+    recording_width = 0;
+    recording_height = 0;
+    dropped_frames = 0;
+
+    worker().push(Task(Task::Open, nullptr, nullptr, directory + "/capture-" + timestamp() + ".y4m", frame_rate));
+}
+
+void Capture::StopRecording() {
+    if (!recording)
+        return;
+
+    recording = false;
+    in_flight.push_back(-1);
+
+    if (dropped_frames)
+        std::cout << "Capture dropped " << dropped_frames << " frames" << std::endl;
+}
+
+bool Capture::IsRecording() {
+    return recording;
+}
+
+void Capture::Update(int width, int height) {
+    if (recording && recording_width && (width != recording_width || height != recording_height)) {
+        std::cout << "Window size changed, recording stopped" << std::endl;
+        StopRecording();
+    }
+
+    collect();
+
+    if (!screenshot_requested && !recording)
+        return;
+
+    const size_t size = width * height * 4;
+
+    // only grows between captures, slots still being read or encoded keep their buffers
+    if (size > capacity) {
+        bool idle = std::all_of(std::begin(slots), std::end(slots), [](const auto &slot) {
+            return slot.state == Slot::Free;
+        });
+
+        if (!idle)
+            return;
+
+        allocate(size);
+    }
+
+    auto &slot = slots[issued % Slots];
+
+    // the worker is behind, drop the frame rather than stall
+    if (slot.state != Slot::Free) {
+        if (recording)
+            dropped_frames++;
+
+        return;
+    }
+
+    slot.width = width;
+    slot.height = height;
+    slot.screenshot = screenshot_requested;
+    slot.recording = recording;
+
+    // with a pack buffer bound the read is queued on the GPU and returns straight away
+    glad_glBindBuffer(gl_pixel_pack_buffer, slot.buffer);
+    glad_glReadPixels(0, 0, width, height, gl_rgba, gl_unsigned_byte, nullptr);
+    glad_glBindBuffer(gl_pixel_pack_buffer, 0);
+
+    slot.fence = glad_glFenceSync(gl_sync_gpu_commands_complete, 0);
+    slot.state = Slot::Reading;
+
+    in_flight.push_back(issued % Slots);
+    issued++;
+
+    screenshot_requested = false;
+
+    if (recording) {
+        recording_width = width;
+        recording_height = height;
+        recorded_frames++;
+
+        if (recording_frames && recorded_frames >= recording_frames)
+            StopRecording();
+    }
+}
+
+void Capture::Shutdown() {
+    StopRecording();
+    screenshot_requested = false;
+
+    // blocking is fine on the way out, the reads have to land before the context goes
+    while (!in_flight.empty() || std::any_of(std::begin(slots), std::end(slots), [](const auto &slot) { return slot.state != Slot::Free; })) {
+        collect();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,50 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <cstdint>
+#include <string>
+
+#include <raylib-cpp.hpp>
+
+// Reads finished frames back through a ring of pixel buffers a few frames late, a worker writes them as PNG or Y4M
+class Capture {
+public:
+    static const int Slots = 4;
+
+    // the game runs from the data directory, so captures go where it was started from
+    static void SetDirectory(const std::string &directory);
+
+    // writes the next frame as a PNG
+    static void Screenshot();
+
+    // 0 frames records until StopRecording, frame_rate only goes in the Y4M header
+    static void StartRecording(uint32_t frames, int frame_rate);
+    static void StopRecording();
+    static bool IsRecording();
+
+    // called by Screen with the finished frame in the back buffer, before it is presented
+    static void Update(int width, int height);
+
+    // waits for every queued read, call before the window closes
+    static void Shutdown();
+};
+
+#endif //CAPTURE_H
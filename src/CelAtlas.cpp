@@ -0,0 +1,146 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <exception>
+#include <string>
+
+#include "CelAtlas.h"
+#include "GLExtensions.h"
+
+// Halves a square RGBA cel. Texels with the palette's transparent index carry no colour, so colour is averaged over
+// the covered texels only and alpha keeps the coverage, which the alpha test cuts at one half.
+static std::vector<uint8_t> downsample(const std::vector<uint8_t> &pixels, int size) {
+    const int half = size / 2;
+    std::vector<uint8_t> result(half * half * 4);
+
+    for (int y = 0; y < half; y++) {
+        for (int x = 0; x < half; x++) {
+            uint32_t r = 0, g = 0, b = 0, a = 0;
+
+            for (int i = 0; i < 4; i++) {
+                const uint8_t *texel = pixels.data() + ((y * 2 + i / 2) * size + x * 2 + i % 2) * 4;
+
+                r += texel[0] * texel[3];
+                g += texel[1] * texel[3];
+                b += texel[2] * texel[3];
+                a += texel[3];
+            }
+
+            uint8_t *target = result.data() + (y * half + x) * 4;
+
+            if (a > 0) {
+                target[0] = (r + a / 2) / a;
+                target[1] = (g + a / 2) / a;
+                target[2] = (b + a / 2) / a;
+            }
+
+            target[3] = (a + 2) / 4;
+        }
+    }
+
+    return result;
+}
+
+CelHandle CelAtlas::add(const raylib::Image &image, bool opaque) {
+    if (image.GetWidth() != CelSize || image.GetHeight() != CelSize)
+        throw std::invalid_argument("Atlas cels must be " + std::to_string(CelSize) + "x" + std::to_string(CelSize));
+
+    size_t index = count % CelsPerPage;
+
+    if (index == 0) {
+        Image blank = GenImageColor(PageSize, PageSize, BLANK);
+
+        raylib::TextureUnmanaged page(blank);
+        page.SetWrap(TEXTURE_WRAP_CLAMP);
+
+        // levels past the last one a cel fills on its own would mix neighbours, so the chain stops there
+        glad_glBindTexture(gl_texture_2d, page.id);
+
+        for (int level = 1; level < MipLevels; level++) {
+            glad_glTexImage2D(gl_texture_2d, level, gl_rgba8, PageSize >> level, PageSize >> level, 0, gl_rgba, gl_unsigned_byte, nullptr);
+        }
+
+        glad_glTexParameteri(gl_texture_2d, gl_texture_max_level, MipLevels - 1);
+        glad_glBindTexture(gl_texture_2d, 0);
+
+        page.mipmaps = MipLevels;
+
+        // nearest within a level keeps the pixel art look up close, blending between levels stops distant shimmer
+        // no anisotropy, at grazing angles its footprint reaches past the cel into its neighbours
+        rlTextureParameters(page.id, RL_TEXTURE_MIN_FILTER, RL_TEXTURE_FILTER_NEAREST_MIP_LINEAR);
+
+        pages.push_back(page);
+
+        UnloadImage(blank);
+    }
+
+    const auto &page = pages.back();
+
+    float x = (index % CelsPerRow) * CelSize;
+    float y = (index / CelsPerRow) * CelSize;
+
+    raylib::Rectangle source(x, y, CelSize, CelSize);
+    UpdateTextureRec(page, source, image.data);
+
+    std::vector<uint8_t> level_pixels((const uint8_t *)image.data, (const uint8_t *)image.data + CelSize * CelSize * 4);
+
+    glad_glBindTexture(gl_texture_2d, page.id);
+
+    for (int level = 1; level < MipLevels; level++) {
+        level_pixels = downsample(level_pixels, CelSize >> (level - 1));
+
+        const int size = CelSize >> level;
+        glad_glTexSubImage2D(gl_texture_2d, level, (int)x >> level, (int)y >> level, size, size, gl_rgba, gl_unsigned_byte, level_pixels.data());
+    }
+
+    glad_glBindTexture(gl_texture_2d, 0);
+
+    const auto *pixels = (const uint32_t *)image.data;
+    texels.resize((count + 1) * CelSize * CelSize);
+    uint32_t *columns = texels.data() + count * CelSize * CelSize;
+
+    for (int row = 0; row < CelSize; row++) {
+        for (int column = 0; column < CelSize; column++) {
+            columns[column * CelSize + row] = pixels[row * CelSize + column];
+        }
+    }
+
+    // pull the UVs in a fraction of a texel so nearest sampling never reaches the neighbouring cel
+    const float inset = 0.01f;
+    raylib::Rectangle uv((x + inset) / PageSize, (y + inset) / PageSize, (CelSize - inset * 2) / PageSize, (CelSize - inset * 2) / PageSize);
+
+    CelHandle handle(page, (uint16_t)count, source, uv, opaque);
+    count += 1;
+
+    return handle;
+}
+
+void CelAtlas::reserveRun(size_t cels) {
+    if (cels > CelsPerPage)
+        throw std::invalid_argument("Runs cannot be longer than " + std::to_string(CelsPerPage) + " cels");
+
+    size_t index = count % CelsPerPage;
+
+    // the skipped slots stay blank, add() starts a page when the index wraps to 0
+    if (index != 0 && index + cels > CelsPerPage)
+        count += CelsPerPage - index;
+}
+
+CelAtlas::~CelAtlas() {
+
+}
@@ -0,0 +1,98 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef CELATLAS_H
+#define CELATLAS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+// Location of one 64x64 cel inside an atlas page
+struct CelHandle {
+    raylib::TextureUnmanaged atlas;
+    uint16_t layer;
+    raylib::Rectangle source;
+    raylib::Rectangle uv;
+    bool opaque;
+};
+
+// Animation over cels in consecutive slots of one page, the first frame is the handle it is drawn with. Loops unless
+// one shot, which holds on the first frame until it starts and then stops on the last, walls only.
+struct CelAnimation {
+    uint16_t frames;
+    uint32_t frameRate;
+
+    bool oneShot = false;
+    std::optional<uint64_t> start = std::nullopt;
+
+    uint16_t getFrame(uint64_t frame_count) const {
+        if (!oneShot)
+            return (frame_count / frameRate) % frames;
+
+        if (!start || frame_count < *start)
+            return 0;
+
+        return std::min<uint64_t>((frame_count - *start) / frameRate, frames - 1);
+    }
+};
+
+class CelAtlas {
+public:
+    static const int CelSize = 64;
+    static const int PageSize = 2048;
+    static const int CelsPerRow = PageSize / CelSize;
+    static const int CelsPerPage = CelsPerRow * CelsPerRow;
+
+    // 64 down to 1, stops before a texel would cover more than one cel
+    static const int MipLevels = 7;
+private:
+    std::vector<raylib::TextureUnmanaged> pages;
+    size_t count = 0;
+
+    // CPU copy for the software renderer, column major so a wall column is contiguous
+    std::vector<uint32_t> texels;
+public:
+    CelAtlas() {
+    }
+
+    CelHandle add(const raylib::Image &image, bool opaque);
+
+    // moves to a fresh page unless the next cels added fit on the current one
+    void reserveRun(size_t cels);
+
+    const std::vector<raylib::TextureUnmanaged> &getPages() const {
+        return pages;
+    }
+
+    size_t getCount() const {
+        return count;
+    }
+
+    // CelSize columns of CelSize RGBA texels, top to bottom
+    const uint32_t *getTexels(uint16_t layer) const {
+        return texels.data() + layer * CelSize * CelSize;
+    }
+
+    ~CelAtlas();
+};
+
+#endif //CELATLAS_H
@@ -36,6 +36,9 @@ CelThree::CelThree(const std::string &filename, const Palette &palette) : filena
 
         auto pixel = palette[index];
 
+        if (pixel.GetA() == 0x00)
+            opaque = false;
+
         pixels.push_back(pixel.GetR());
         pixels.push_back(pixel.GetG());
         pixels.push_back(pixel.GetB());
@@ -45,12 +48,9 @@ CelThree::CelThree(const std::string &filename, const Palette &palette) : filena
     auto bytes = new uint8_t[pixels.size()];
     std::memcpy(bytes, pixels.data(), pixels.size());
 
-    auto image = raylib::Image(bytes, 64, 64, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    image = raylib::Image(bytes, 64, 64, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
     image = image.RotateCW();
     image = image.FlipHorizontal();
-
-    texture = raylib::TextureUnmanaged(image); 
-    texture.SetWrap(TEXTURE_WRAP_CLAMP);
 }
 
 CelThree::~CelThree() {
@@ -28,12 +28,18 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 class CelThree {
     const std::string filename;
-    raylib::TextureUnmanaged texture;
+    raylib::Image image;
+    bool opaque = true;
 public:
     CelThree(const std::string &filename, const Palette &palette);
 
-    const raylib::TextureUnmanaged &getTexture() const {
-        return texture;
+    const raylib::Image &getImage() const {
+        return image;
+    }
+
+    // true when no texel uses the transparent palette index
+    bool isOpaque() const {
+        return opaque;
     }
 
     ~CelThree();
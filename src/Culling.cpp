@@ -0,0 +1,243 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Culling.h"
+#include "Entity.h"
+#include "VisibilitySet.h"
+
+static const float wall_height = 12.0f;
+static const float billboard_height = 5.0f;
+static const float billboard_size = 5.0f;
+static const float billboard_radius = 7.1f;
+
+Frustum::Frustum(const raylib::Camera3D *camera, float draw_distance) : origin(camera->GetPosition()), drawDistance(draw_distance) {
+    Matrix m = MatrixMultiply(camera->GetMatrix(), rlGetMatrixProjection());
+
+    const float rows[4][4] = {
+        {m.m0, m.m4, m.m8, m.m12},
+        {m.m1, m.m5, m.m9, m.m13},
+        {m.m2, m.m6, m.m10, m.m14},
+        {m.m3, m.m7, m.m11, m.m15},
+    };
+
+    // left, right, bottom, top, near, far
+    for (size_t i = 0; i < planes.size(); i++) {
+        const float *row = rows[i / 2];
+        const float sign = (i % 2) ? -1.0f : 1.0f;
+
+        raylib::Vector3 normal(rows[3][0] + sign*row[0], rows[3][1] + sign*row[1], rows[3][2] + sign*row[2]);
+        float distance = rows[3][3] + sign*row[3];
+        float length = normal.Length();
+
+        planes[i] = Plane(normal / length, distance / length);
+    }
+}
+
+bool Frustum::containsSphere(const raylib::Vector3 &centre, float radius) const {
+    if (drawDistance > 0.0f && centre.Distance(origin) - radius > drawDistance)
+        return false;
+
+    for (const auto &plane : planes) {
+        if (plane.normal.DotProduct(centre) + plane.distance < -radius)
+            return false;
+    }
+
+    return true;
+}
+
+bool Frustum::containsBox(const BoundingBox &box) const {
+    if (drawDistance > 0.0f) {
+        raylib::Vector3 nearest(std::clamp(origin.x, box.min.x, box.max.x), std::clamp(origin.y, box.min.y, box.max.y), std::clamp(origin.z, box.min.z, box.max.z));
+
+        if (nearest.Distance(origin) > drawDistance)
+            return false;
+    }
+
+    for (const auto &plane : planes) {
+        // the corner furthest along the plane normal
+        raylib::Vector3 corner(plane.normal.x >= 0.0f ? box.max.x : box.min.x, plane.normal.y >= 0.0f ? box.max.y : box.min.y, plane.normal.z >= 0.0f ? box.max.z : box.min.z);
+
+        if (plane.normal.DotProduct(corner) + plane.distance < 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+void Frustum::containsSegments(const SegmentArrays &arrays, const std::vector<float> &radii, const std::vector<uint32_t> &indices, std::vector<uint8_t> &visible) const {
+    const size_t count = indices.size();
+
+    visible.resize(arrays.size());
+
+    // the corner furthest along each plane normal, the box always spans 0 to wall_height vertically
+    std::array<bool, 6> max_x;
+    std::array<bool, 6> max_z;
+    std::array<float, 6> offsets;
+
+    for (size_t p = 0; p < planes.size(); p++) {
+        max_x[p] = planes[p].normal.x >= 0.0f;
+        max_z[p] = planes[p].normal.z >= 0.0f;
+        offsets[p] = planes[p].distance + (planes[p].normal.y >= 0.0f ? planes[p].normal.y * wall_height : 0.0f);
+    }
+
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128 size = _mm_set1_ps(billboard_size);
+    const __m128 origin_x = _mm_set1_ps(origin.x);
+    const __m128 origin_z = _mm_set1_ps(origin.z);
+    const __m128 draw_distance = _mm_set1_ps(drawDistance);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4) {
+        const uint32_t *lanes = &indices[i];
+
+        // the listed segments are scattered through the arrays, so each lane is loaded on its own
+        auto gather = [lanes](const std::vector<float> &values) {
+            return _mm_setr_ps(values[lanes[0]], values[lanes[1]], values[lanes[2]], values[lanes[3]]);
+        };
+
+        __m128 x1 = gather(arrays.x1);
+        __m128 x2 = gather(arrays.x2);
+        __m128 z1 = gather(arrays.y1);
+        __m128 z2 = gather(arrays.y2);
+
+        __m128 min_x = _mm_sub_ps(_mm_min_ps(x1, x2), size);
+        __m128 box_max_x = _mm_add_ps(_mm_max_ps(x1, x2), size);
+        __m128 min_z = _mm_sub_ps(_mm_min_ps(z1, z2), size);
+        __m128 box_max_z = _mm_add_ps(_mm_max_ps(z1, z2), size);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+
+        if (drawDistance > 0.0f) {
+            __m128 dx = _mm_sub_ps(gather(arrays.midX), origin_x);
+            __m128 dz = _mm_sub_ps(gather(arrays.midY), origin_z);
+            __m128 reach = _mm_add_ps(draw_distance, gather(radii));
+
+            inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)), _mm_mul_ps(reach, reach)));
+        }
+
+        for (size_t p = 0; p < planes.size(); p++) {
+            __m128 corner_x = max_x[p] ? box_max_x : min_x;
+            __m128 corner_z = max_z[p] ? box_max_z : min_z;
+
+            __m128 dot = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].normal.x), corner_x), _mm_mul_ps(_mm_set1_ps(planes[p].normal.z), corner_z));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dot, _mm_set1_ps(offsets[p])), zero));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+
+        for (size_t lane = 0; lane < 4; lane++) {
+            visible[lanes[lane]] = (mask >> lane) & 1;
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        const uint32_t index = indices[i];
+
+        float min_x = std::min(arrays.x1[index], arrays.x2[index]) - billboard_size;
+        float box_max_x = std::max(arrays.x1[index], arrays.x2[index]) + billboard_size;
+        float min_z = std::min(arrays.y1[index], arrays.y2[index]) - billboard_size;
+        float box_max_z = std::max(arrays.y1[index], arrays.y2[index]) + billboard_size;
+
+        bool inside = true;
+
+        if (drawDistance > 0.0f) {
+            float dx = arrays.midX[index] - origin.x;
+            float dz = arrays.midY[index] - origin.z;
+            float reach = drawDistance + radii[index];
+
+            inside = dx * dx + dz * dz <= reach * reach;
+        }
+
+        for (size_t p = 0; p < planes.size(); p++) {
+            float corner_x = max_x[p] ? box_max_x : min_x;
+            float corner_z = max_z[p] ? box_max_z : min_z;
+
+            inside = inside && planes[p].normal.x * corner_x + planes[p].normal.z * corner_z + offsets[p] >= 0.0f;
+        }
+
+        visible[index] = inside;
+    }
+}
+
+BoundingBox Culling::GetSegmentBounds(const Segment &segment) {
+    float min_x = std::min(segment.x1, segment.x2);
+    float max_x = std::max(segment.x1, segment.x2);
+    float min_y = std::min(segment.y1, segment.y2);
+    float max_y = std::max(segment.y1, segment.y2);
+
+    return GetAreaBounds(raylib::Rectangle(min_x, min_y, max_x - min_x, max_y - min_y));
+}
+
+BoundingBox Culling::GetAreaBounds(const raylib::Rectangle &area) {
+    // padded so the same box holds a wall or a billboard standing anywhere in the area
+    return BoundingBox(Vector3(area.x - billboard_size, 0.0f, area.y - billboard_size), Vector3(area.x + area.width + billboard_size, wall_height, area.y + area.height + billboard_size));
+}
+
+Culling::Culling(const Map &map) : arrays(map.getSegmentArrays()) {
+    for (size_t i = 0; i < arrays.size(); i++) {
+        // half the diagonal of the GetSegmentBounds box across the ground
+        float half_width = std::fabs(arrays.x2[i] - arrays.x1[i]) / 2.0f + billboard_size;
+        float half_depth = std::fabs(arrays.y2[i] - arrays.y1[i]) / 2.0f + billboard_size;
+
+        radii.push_back(std::sqrt(half_width * half_width + half_depth * half_depth));
+    }
+}
+
+void Culling::update(const Frustum &frustum, const uint64_t *potentially_visible, const std::vector<uint32_t> &in_view) {
+    potentiallyVisible = potentially_visible;
+
+    frustum.containsSegments(arrays, radii, in_view, inFrustum);
+
+    visibleCount = 0;
+    culledCount = 0;
+}
+
+bool Culling::isVisible(const Frustum &frustum, const Segment &segment, const Entity *entity) {
+    bool visible = false;
+
+    auto position_if = entity ? entity->getPosition() : std::nullopt;
+
+    if (position_if) {
+        visible = frustum.containsSphere(raylib::Vector3(position_if->x, billboard_height, position_if->y), billboard_radius);
+    } else if (potentiallyVisible && !VisibilitySet::Test(potentiallyVisible, segment.index)) {
+        visible = false;
+    } else {
+        visible = inFrustum[segment.index];
+    }
+
+    if (visible)
+        visibleCount++;
+    else
+        culledCount++;
+
+    return visible;
+}
+
+Culling::~Culling() {
+
+}
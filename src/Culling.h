@@ -0,0 +1,92 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <cstdint>
+#include <array>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+#include "Map.h"
+
+class Entity;
+
+class Frustum {
+    struct Plane {
+        raylib::Vector3 normal;
+        float distance;
+    };
+
+    std::array<Plane, 6> planes;
+    raylib::Vector3 origin;
+    float drawDistance;
+public:
+    // built from the rlgl matrices, so only valid inside camera->BeginMode()
+    Frustum(const raylib::Camera3D *camera, float draw_distance);
+
+    bool containsSphere(const raylib::Vector3 &centre, float radius) const;
+    bool containsBox(const BoundingBox &box) const;
+
+    // tests the box GetSegmentBounds would give each listed segment, four at a time with SSE2, and sets visible[index].
+    // The draw distance is checked against a circle of radii[index] around the middle of the segment rather than the
+    // nearest corner.
+    void containsSegments(const SegmentArrays &arrays, const std::vector<float> &radii, const std::vector<uint32_t> &indices, std::vector<uint8_t> &visible) const;
+};
+
+class Culling {
+    const SegmentArrays &arrays;
+
+    // how far the bounds of each segment reach from its middle
+    std::vector<float> radii;
+
+    // the segments in view tested against the frustum in one pass per frame, indexed by segment
+    std::vector<uint8_t> inFrustum;
+
+    const uint64_t *potentiallyVisible = nullptr;
+
+    size_t visibleCount = 0;
+    size_t culledCount = 0;
+public:
+    static BoundingBox GetSegmentBounds(const Segment &segment);
+    static BoundingBox GetAreaBounds(const raylib::Rectangle &area);
+
+    Culling(const Map &map);
+
+    // tests the segments in_view lists against the frustum and resets the counters, potentially_visible is an optional
+    // VisibilitySet row
+    void update(const Frustum &frustum, const uint64_t *potentially_visible, const std::vector<uint32_t> &in_view);
+
+    // static segments read the result of update() so must be in the list it was given, entities with a position test
+    // their sphere
+    bool isVisible(const Frustum &frustum, const Segment &segment, const Entity *entity);
+
+    size_t getVisibleCount() const {
+        return visibleCount;
+    }
+
+    size_t getCulledCount() const {
+        return culledCount;
+    }
+
+    ~Culling();
+};
+
+#endif //CULLING_H
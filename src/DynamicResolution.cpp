@@ -0,0 +1,66 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+
+#include "DynamicResolution.h"
+
+// dropping a step needs a real miss, raising one needs room for the extra pixels
+static const float drop_threshold = 1.1f;
+static const float raise_threshold = 0.8f;
+
+DynamicResolution::DynamicResolution(int min_scale, int max_scale, int target_fps) : minScale(min_scale), maxScale(max_scale), scale(max_scale), budget(1.0f / target_fps) {
+}
+
+int DynamicResolution::update(float frame_time, float busy_time) {
+    samples.push_back(Sample(frame_time, busy_time));
+
+    if (samples.size() < WindowSize)
+        return scale;
+
+    float frame_average = 0.0f;
+    float busy_average = 0.0f;
+
+    for (const auto &sample : samples) {
+        frame_average += sample.frameTime;
+        busy_average += sample.busyTime;
+    }
+
+    frame_average /= samples.size();
+    busy_average /= samples.size();
+
+    samples.pop_front();
+
+    // fill cost grows with the square of the scale
+    float growth = ((scale + 1.0f) * (scale + 1.0f)) / (scale * scale);
+
+    int new_scale = scale;
+
+    if (frame_average > budget * drop_threshold)
+        new_scale = std::max(minScale, scale - 1);
+    else if (busy_average * growth < budget * raise_threshold)
+        new_scale = std::min(maxScale, scale + 1);
+
+    // a change invalidates the window, wait for a full one at the new size
+    if (new_scale != scale) {
+        scale = new_scale;
+        samples.clear();
+    }
+
+    return scale;
+}
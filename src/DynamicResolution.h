@@ -0,0 +1,51 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include <cstdint>
+#include <deque>
+
+// Picks the internal render scale from recent frame times
+class DynamicResolution {
+    struct Sample {
+        float frameTime;
+        float busyTime;
+    };
+
+    std::deque<Sample> samples;
+
+    int minScale;
+    int maxScale;
+    int scale;
+    float budget;
+public:
+    static const size_t WindowSize = 60;
+
+    DynamicResolution(int min_scale, int max_scale, int target_fps);
+
+    // frame_time includes the frame limiter wait, busy_time is what drawing cost on the slower of the CPU and GPU
+    int update(float frame_time, float busy_time);
+
+    int getScale() const {
+        return scale;
+    }
+};
+
+#endif //DYNAMICRESOLUTION_H
@@ -21,95 +21,61 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Entity.h"
 #include "Player.h"
 #include "SoundCache.h"
+#include "RenderQueue.h"
 
-static const char *fragment_shader = R"(
-#version 330
-
-// Input vertex attributes (from vertex shader)
-in vec2 fragTexCoord;
-in vec4 fragColor;
-
-// Input uniform values
-uniform sampler2D texture0;
-uniform vec4 colDiffuse;
-
-// Output fragment color
-out vec4 finalColor;
-
-void main()
-{
-    vec4 texelColor = texture(texture0, fragTexCoord);
-    if (texelColor.a == 0.0) discard;
-    finalColor = texelColor * fragColor * colDiffuse;
-})";
-
-static void draw_wall(const uint16_t x1, const uint16_t y1, const uint16_t x2, const uint16_t y2, const raylib::TextureUnmanaged &texture) {
-    const float height = 12.0f;
-
-    static raylib::ShaderUnmanaged shader = raylib::ShaderUnmanaged::LoadFromMemory(nullptr, fragment_shader);
-
-    shader.BeginMode();
-    {
-        rlBegin(RL_TRIANGLES);
-        rlSetTexture(texture.id);
+static void draw_wall(const uint16_t x1, const uint16_t y1, const uint16_t x2, const uint16_t y2, const CelHandle &texture) {
+    RenderQueue::SubmitWall(x1, y1, x2, y2, texture);
+}
 
-        if (y1 == y2) {
-            rlTexCoord2f(0.0, 1.0);
-            rlVertex3f(x1, 0, y1);
+static void draw_entity(const raylib::Camera3D *camera, const uint16_t x1, const uint16_t y1, const uint16_t x2, const uint16_t y2, const CelHandle &texture, const std::optional<CelAnimation> &animation = std::nullopt) {
+    const float y_offset = 5.0f;
+    const float scale = 10.0f;
 
-            rlTexCoord2f(1.0, 1.0);
-            rlVertex3f(x2, 0, y1);
+    float mid_x = x1;
+    float mid_y = y1;
 
-            rlTexCoord2f(1.0, 0.0);
-            rlVertex3f(x2, height, y1);
+    RenderQueue::SubmitBillboard(Vector3(mid_x, y_offset, mid_y), scale, texture, animation);
+}
 
-            rlTexCoord2f(1.0, 0.0);
-            rlVertex3f(x2, height, y1);
+std::optional<raylib::RayCollision> HitShape::collide(const raylib::Ray &ray) const {
+    auto collision = type == Type::Sphere ?
+        ray.GetCollision(start, size) :
+        ray.GetCollision(start, end, raylib::Vector3(end.x, size, end.z), raylib::Vector3(start.x, size, start.z));
 
-            rlTexCoord2f(0.0, 0.0);
-            rlVertex3f(x1, height, y1);
+    // a missed sphere still reports a distance, and one behind the ray a negative one
+    if (collision.GetHit() && collision.GetDistance() > 0.0f)
+        return collision;
 
-            rlTexCoord2f(0.0, 1.0);
-            rlVertex3f(x1, 0, y1);
-        } else {
-            rlTexCoord2f(0.0, 1.0);
-            rlVertex3f(x1, 0, y1);
+    return std::nullopt;
+}
 
-            rlTexCoord2f(1.0, 1.0);
-            rlVertex3f(x1, 0, y2);
+std::optional<raylib::RayCollision> Entity::collide(const raylib::Ray &ray) {
+    auto shape = getHitShape();
 
-            rlTexCoord2f(1.0, 0.0);
-            rlVertex3f(x1, height, y2);
+    if (!shape)
+        return std::nullopt;
 
-            rlTexCoord2f(1.0, 0.0);
-            rlVertex3f(x1, height, y2);
+    return shape->collide(ray);
+}
 
-            rlTexCoord2f(0.0, 0.0);
-            rlVertex3f(x1, height, y1);
+std::pair<raylib::Vector2, float> Entity::getSegmentBounds() const {
+    if (y1 == y2) {
+        float min_x = std::min(x1, x2);
+        float max_x = std::max(x1, x2);
 
-            rlTexCoord2f(0.0, 1.0);
-            rlVertex3f(x1, 0, y1);
-        }
+        float radius = (max_x - min_x) / 2.0f;
+        float centre_x = min_x + radius;
 
-        rlEnd();
+        return std::make_pair(raylib::Vector2(centre_x, y1), radius);
     }
-    shader.EndMode();
-}
-
-static void draw_entity(const raylib::Camera3D *camera, const uint16_t x1, const uint16_t y1, const uint16_t x2, const uint16_t y2, const raylib::TextureUnmanaged &texture) {
-    const float y_offset = 5.0f;
-    const float scale = 10.0f;
 
-    float mid_x = x1;
-    float mid_y = y1;
+    float min_y = std::min(y1, y2);
+    float max_y = std::max(y1, y2);
 
-    static raylib::ShaderUnmanaged shader = raylib::ShaderUnmanaged::LoadFromMemory(nullptr, fragment_shader);
+    float radius = (max_y - min_y) / 2.0f;
+    float centre_y = min_y + radius;
 
-    shader.BeginMode();
-    {
-        camera->DrawBillboard(texture, Vector3(mid_x, y_offset, mid_y), scale);
-    }
-    shader.EndMode();
+    return std::make_pair(raylib::Vector2(x1, centre_y), radius);
 }
 
 Entity::~Entity() {
@@ -135,41 +101,13 @@ void DamageableWall::draw(const raylib::Camera3D *camera, uint64_t frame_count)
         draw_wall(x1, y1, x2, y2, texture);
 }
 
-std::optional<raylib::RayCollision> DamageableWall::collide(const raylib::Ray &ray) {
-    if (isDamaged)
-        return std::nullopt;
-
-    const float height = 12.0f;
-
-    if (y1 == y2) {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x2, 0, y1);
-        auto c = raylib::Vector3(x2, height, y1);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    } else {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x1, 0, y2);
-        auto c = raylib::Vector3(x1, height, y2);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    }
-
-    return std::nullopt;
-}
-
 void RoomEntry::touch(Player *player) {
     player->setState(scene);
 }
 
+// only reached by the software renderer, StaticGeometry animates the baked wall on the GPU
 void AnimatedWall::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
-    size_t anim = frame_count / frameRate; 
+    size_t anim = frame_count / frameRate;
 
     auto texture = textures[anim % textures.size()];
 
@@ -198,32 +136,6 @@ void Door::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
         draw_wall(x1, y1, x2, y2, closedTexture);
 }
 
-std::optional<raylib::RayCollision> ClosedDoor::collide(const raylib::Ray &ray) {
-    const float height = 12.0f;
-
-    if (y1 == y2) {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x2, 0, y1);
-        auto c = raylib::Vector3(x2, height, y1);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    } else {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x1, 0, y2);
-        auto c = raylib::Vector3(x1, height, y2);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    }
-
-    return std::nullopt;
-}
-
 void ClosedDoor::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
     if (state == DoorState::Closed) {
         draw_wall(x1, y1, x2, y2, textures[0]);
@@ -236,15 +148,23 @@ void ClosedDoor::draw(const raylib::Camera3D *camera, uint64_t frame_count) cons
 
 void ClosedDoor::update(Player *player, uint64_t frame_count) {
     if (state == DoorState::Opening) {
-        size_t anim = frame_count / frameRate;
-        frame = anim % textures.size();
+        if (!start)
+            start = frame_count;
+
+        frame = getWallAnimation()->getFrame(frame_count);
 
         if (frame == textures.size()-1) {
             state = DoorState::Opened;
+            setChanged();
         }
     }
 }
 
+std::optional<CelAnimation> ClosedDoor::getWallAnimation() const {
+    // opened without playing, like a cut fence, counts as started long ago so it shows the last frame
+    return CelAnimation(textures.size(), frameRate, true, state == DoorState::Opened ? start.value_or(0) : start);
+}
+
 void ClosedDoorPlayAnim::touch(Player *player) {
     ClosedDoor::touch(player);
 
@@ -258,6 +178,7 @@ void ElectrifiedFence::use(Player *player, std::optional<Item> item_if) {
     if (item_if || *item_if == Item::BoltCutters) {
         if (player->testFlag(Flag::PowerOff)) {
             state = DoorState::Opened;
+            setChanged();
         } else {
             player->takeDamage(999, DeathType::Fence);
         }
@@ -273,32 +194,6 @@ void ElectrifiedFence::update(Player *player, uint64_t frame_count) {
     ClosedDoor::update(player, frame_count);
 }
 
-std::optional<raylib::RayCollision> Barricade::collide(const raylib::Ray &ray) {
-    const float height = 12.0f;
-
-    if (y1 == y2) {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x2, 0, y1);
-        auto c = raylib::Vector3(x2, height, y1);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    } else {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x1, 0, y2);
-        auto c = raylib::Vector3(x1, height, y2);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    }
-
-    return std::nullopt;
-}
-
 void BarricadedRoomEntry::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
     if (open)
         draw_wall(x1, y1, x2, y2, openedTexture);
@@ -310,58 +205,6 @@ void BarricadedRoomEntry::touch(Player *player) {
     player->setState(scene);
 }
 
-std::optional<raylib::RayCollision> BarricadedRoomEntry::collide(const raylib::Ray &ray) {
-    const float height = 12.0f;
-
-    if (y1 == y2) {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x2, 0, y1);
-        auto c = raylib::Vector3(x2, height, y1);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    } else {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x1, 0, y2);
-        auto c = raylib::Vector3(x1, height, y2);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    }
-
-    return std::nullopt;
-}
-
-std::optional<raylib::RayCollision> ClosedRoomEntry::collide(const raylib::Ray &ray) {
-    const float height = 12.0f;
-
-    if (y1 == y2) {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x2, 0, y1);
-        auto c = raylib::Vector3(x2, height, y1);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    } else {
-        auto a = raylib::Vector3(x1, 0, y1);
-        auto b = raylib::Vector3(x1, 0, y2);
-        auto c = raylib::Vector3(x1, height, y2);
-        auto d = raylib::Vector3(x1, height, y1);
-
-        auto collision = ray.GetCollision(a, b, c, d);
-        if (collision.GetDistance())
-            return collision;
-    }
-
-    return std::nullopt;
-}
-
 void ClosedRoomEntry::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
     if (state == DoorState::Closed) {
         draw_wall(x1, y1, x2, y2, textures[0]);
@@ -374,15 +217,22 @@ void ClosedRoomEntry::draw(const raylib::Camera3D *camera, uint64_t frame_count)
 
 void ClosedRoomEntry::update(Player *player, uint64_t frame_count) {
     if (state == DoorState::Opening) {
-        size_t anim = frame_count / frameRate;
-        frame = anim % textures.size();
+        if (!start)
+            start = frame_count;
+
+        frame = getWallAnimation()->getFrame(frame_count);
 
         if (frame == textures.size()-1) {
             state = DoorState::Opened;
+            setChanged();
         }
     }
 }
 
+std::optional<CelAnimation> ClosedRoomEntry::getWallAnimation() const {
+    return CelAnimation(textures.size(), frameRate, true, start);
+}
+
 void ClosedRoomEntry::touch(Player *player) {
     player->setState(scene);
 }
@@ -391,41 +241,18 @@ void Prop::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
     draw_entity(camera, x1, y1, x2, y2, texture);
 }
 
-std::optional<std::pair<raylib::Vector2, float>> Prop::getBounds() const {
-    if (y1 == y2) {
-        float min_x = std::min(x1, x2);
-        float max_x = std::max(x1, x2);
-
-        float radius = (max_x - min_x) / 2.0f;
-        float centre_x = min_x + radius;
-
-        return std::make_pair(raylib::Vector2(centre_x, y1), radius);
-    }
-
-    float min_y = std::min(y1, y2);
-    float max_y = std::max(y1, y2);
-
-    float radius = (max_y - min_y) / 2.0f;
-    float centre_y = min_y + radius;
-
-    return std::make_pair(raylib::Vector2(x1, centre_y), radius);
-}
-
 void DamageableProp::damage(Player *player, const DamageType damage_type, int amount) {
     isDamaged = true;
+    setChanged();
 }
 
-std::optional<raylib::RayCollision> DamageableProp::collide(const raylib::Ray &ray) {
+std::optional<HitShape> DamageableProp::getHitShape() const {
     if (isDamaged)
         return std::nullopt;
 
     const float height = 6.0f;
 
-    auto collision = ray.GetCollision(raylib::Vector3(position.GetX(), height, position.GetY()), height);
-    if (collision.GetDistance())
-        return collision;
-
-    return std::nullopt;
+    return HitShape::Sphere(raylib::Vector3(position.GetX(), height, position.GetY()), height);
 }
 
 void DamageableProp::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
@@ -435,56 +262,11 @@ void DamageableProp::draw(const raylib::Camera3D *camera, uint64_t frame_count)
         draw_entity(camera, x1, y1, x2, y2, texture);
 }
 
-std::optional<std::pair<raylib::Vector2, float>> DamageableProp::getBounds() const {
-    if (y1 == y2) {
-        float min_x = std::min(x1, x2);
-        float max_x = std::max(x1, x2);
-
-        float radius = (max_x - min_x) / 2.0f;
-        float centre_x = min_x + radius;
-
-        return std::make_pair(raylib::Vector2(centre_x, y1), radius);
-    }
-
-    float min_y = std::min(y1, y2);
-    float max_y = std::max(y1, y2);
-
-    float radius = (max_y - min_y) / 2.0f;
-    float centre_y = min_y + radius;
-
-    return std::make_pair(raylib::Vector2(x1, centre_y), radius);
-}
-
-
 void AnimatedProp::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
-    size_t anim = frame_count / frameRate;
-
-    auto texture = textures[anim % textures.size()];
-
-    draw_entity(camera, x1, y1, x2, y2, texture);
-}
-
-std::optional<std::pair<raylib::Vector2, float>> AnimatedProp::getBounds() const {
-    if (y1 == y2) {
-        float min_x = std::min(x1, x2);
-        float max_x = std::max(x1, x2);
-
-        float radius = (max_x - min_x) / 2.0f;
-        float centre_x = min_x + radius;
-
-        return std::make_pair(raylib::Vector2(centre_x, y1), radius);
-    }
-
-    float min_y = std::min(y1, y2);
-    float max_y = std::max(y1, y2);
-
-    float radius = (max_y - min_y) / 2.0f;
-    float centre_y = min_y + radius;
-
-    return std::make_pair(raylib::Vector2(x1, centre_y), radius);
+    // the billboard shader picks the frame, textures are consecutive atlas slots
+    draw_entity(camera, x1, y1, x2, y2, textures[0], CelAnimation(textures.size(), frameRate));
 }
 
-
 void Trap::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
     if (triggered)
         return;
@@ -498,49 +280,10 @@ void Trap::touch(Player *player) {
         return;
 
     triggered = true;
+    setChanged();
     player->takeDamage(999, deathType);
 }
 
-std::optional<std::pair<raylib::Vector2, float>> Trap::getBounds() const {
-    if (y1 == y2) {
-        float min_x = std::min(x1, x2);
-        float max_x = std::max(x1, x2);
-
-        float radius = (max_x - min_x) / 2.0f;
-        float centre_x = min_x + radius;
-
-        return std::make_pair(raylib::Vector2(centre_x, y1), radius);
-    }
-
-    float min_y = std::min(y1, y2);
-    float max_y = std::max(y1, y2);
-
-    float radius = (max_y - min_y) / 2.0f;
-    float centre_y = min_y + radius;
-
-    return std::make_pair(raylib::Vector2(x1, centre_y), radius);
-}
-
-std::optional<std::pair<raylib::Vector2, float>> ItemPickup::getBounds() const {
-    if (y1 == y2) {
-        float min_x = std::min(x1, x2);
-        float max_x = std::max(x1, x2);
-
-        float radius = (max_x - min_x) / 2.0f;
-        float centre_x = min_x + radius;
-
-        return std::make_pair(raylib::Vector2(centre_x, y1), radius);
-    }
-
-    float min_y = std::min(y1, y2);
-    float max_y = std::max(y1, y2);
-
-    float radius = (max_y - min_y) / 2.0f;
-    float centre_y = min_y + radius;
-
-    return std::make_pair(raylib::Vector2(x1, centre_y), radius);
-}
-
 void ItemPickup::draw(const raylib::Camera3D *camera, uint64_t frame_count) const {
     if (taken)
         return;
@@ -554,4 +297,5 @@ void ItemPickup::touch(Player *player) {
 
     player->addItem(item, count);
     taken = true;
+    setChanged();
 }
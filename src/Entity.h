@@ -23,21 +23,63 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <unordered_map>
 #include <functional>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include <raylib-cpp.hpp>
 
 #include "Game.h"
+#include "CelAtlas.h"
 #include "Segment.h"
 #include "Entrance.h"
 
 class Player;
 
+// What a ray can hit on an entity, an upright quad along one axis or a sphere
+struct HitShape {
+    enum class Type {
+        Quad,
+        Sphere,
+    };
+
+    Type type;
+
+    // quad ends on the ground and height, or sphere centre and radius
+    raylib::Vector3 start;
+    raylib::Vector3 end;
+    float size;
+
+    // same collapse to an axis aligned line as the wall renderers
+    static HitShape Quad(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, float height) {
+        if (y1 == y2)
+            return HitShape(Type::Quad, raylib::Vector3(x1, 0, y1), raylib::Vector3(x2, 0, y1), height);
+
+        return HitShape(Type::Quad, raylib::Vector3(x1, 0, y1), raylib::Vector3(x1, 0, y2), height);
+    }
+
+    static HitShape Sphere(const raylib::Vector3 &centre, float radius) {
+        return HitShape(Type::Sphere, centre, centre, radius);
+    }
+
+    // only hits in front of the ray count
+    std::optional<raylib::RayCollision> collide(const raylib::Ray &ray) const;
+};
+
 class Entity {
+    bool changed = false;
 protected:
     uint16_t x1;
     uint16_t y1;
     uint16_t x2;
     uint16_t y2;
+
+    // collide() or getBounds() now answer differently, SpatialIndex refreshes its copy on the next update
+    void setChanged() {
+        changed = true;
+    }
+
+    // billboards stand on the middle of their segment and reach to either end
+    std::pair<raylib::Vector2, float> getSegmentBounds() const;
 public:
     Entity(const Segment *segment) {
         x1 = segment->x1;
@@ -58,7 +100,10 @@ public:
     virtual void damage(Player *player, const DamageType damage_type, int amount) {
     }
 
-    virtual std::optional<raylib::RayCollision> collide(const raylib::Ray &ray) {
+    // tests getHitShape(), so single rays and RayPacket agree
+    virtual std::optional<raylib::RayCollision> collide(const raylib::Ray &ray);
+
+    virtual std::optional<HitShape> getHitShape() const {
         return std::nullopt;
     }
 
@@ -69,6 +114,11 @@ public:
         return std::nullopt;
     }
 
+    // true once after every setChanged()
+    bool takeChanged() {
+        return std::exchange(changed, false);
+    }
+
     virtual std::optional<raylib::Vector2> getPosition() const {
         return std::nullopt;
     }
@@ -77,16 +127,36 @@ public:
         return SegmentType::Unknown;
     }
 
+    // Where a billboard that never moves is drawn, anything else is ordered as a wall
+    virtual std::optional<raylib::Vector2> getBillboardPosition() const {
+        return std::nullopt;
+    }
+
     virtual void use(Player *player, std::optional<Item> item_if) {
     }
 
+    // Every texture a wall can show, walls returning any are baked into the level StaticGeometry
+    virtual std::vector<const CelHandle *> getWallTextures() const {
+        return {};
+    }
+
+    // Texture a baked wall is currently showing
+    virtual const CelHandle *getWallTexture() const {
+        return nullptr;
+    }
+
+    // Baked walls that loop through frames on their own, the shader steps on from getWallTexture
+    virtual std::optional<CelAnimation> getWallAnimation() const {
+        return std::nullopt;
+    }
+
     virtual ~Entity();
 };
 
 class Wall : public Entity {
-    const raylib::TextureUnmanaged &texture;
+    const CelHandle &texture;
 public:
-    Wall(const Segment *segment, const raylib::TextureUnmanaged &texture) : Entity(segment), texture(texture) {
+    Wall(const Segment *segment, const CelHandle &texture) : Entity(segment), texture(texture) {
     }
 
     Collision collide() const {
@@ -95,39 +165,61 @@ public:
 
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
 
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&texture};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return &texture;
+    }
+
     SegmentType getType() const {
         return SegmentType::Wall;
     }
 };
 
 class DamageableWall : public Entity {
-    const raylib::TextureUnmanaged &texture;
-    const raylib::TextureUnmanaged &damaged;
+    const CelHandle &texture;
+    const CelHandle &damaged;
     Collision collision;
     bool isDamaged = false;
 public:
-    DamageableWall(const Segment *segment, const raylib::TextureUnmanaged &texture, const raylib::TextureUnmanaged &damaged) : Entity(segment), texture(texture), damaged(damaged) {
+    DamageableWall(const Segment *segment, const CelHandle &texture, const CelHandle &damaged) : Entity(segment), texture(texture), damaged(damaged) {
     }
 
     Collision collide() const {
         return Collision::Block;
     }
 
-    std::optional<raylib::RayCollision> collide(const raylib::Ray &ray);
+    std::optional<HitShape> getHitShape() const {
+        if (isDamaged)
+            return std::nullopt;
+
+        return HitShape::Quad(x1, y1, x2, y2, 12.0f);
+    }
+
     void damage(Player *player, const DamageType damage_type, int amount);
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
 
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&texture, &damaged};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return isDamaged ? &damaged : &texture;
+    }
+
     SegmentType getType() const {
         return SegmentType::Wall;
     }
 };
 
 class AnimatedWall : public Entity {
-    const std::vector<raylib::TextureUnmanaged> &textures;
+    const std::vector<CelHandle> &textures;
     uint32_t frameRate;
 
 public:
-    AnimatedWall(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, uint32_t frame_rate) : Entity(segment), textures(textures), frameRate(frame_rate) {
+    AnimatedWall(const Segment *segment, const std::vector<CelHandle> &textures, uint32_t frame_rate) : Entity(segment), textures(textures), frameRate(frame_rate) {
     }
 
     Collision collide() const {
@@ -136,6 +228,18 @@ public:
 
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
 
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&textures[0]};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return &textures[0];
+    }
+
+    std::optional<CelAnimation> getWallAnimation() const {
+        return CelAnimation(textures.size(), frameRate);
+    }
+
     SegmentType getType() const {
         return SegmentType::Wall;
     }
@@ -159,9 +263,17 @@ public:
 };
 
 class Passage : public Portal {
-    const raylib::TextureUnmanaged &texture;
+    const CelHandle &texture;
 public:
-    Passage(const Segment *segment, const raylib::TextureUnmanaged &texture, const Entrance &entrance) : Portal(segment, entrance), texture(texture) {
+    Passage(const Segment *segment, const CelHandle &texture, const Entrance &entrance) : Portal(segment, entrance), texture(texture) {
+    }
+
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&texture};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return &texture;
     }
 
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
@@ -170,10 +282,10 @@ public:
 class Door : public Portal {
 protected:
     bool open = false;
-    const raylib::TextureUnmanaged &closedTexture;
-    const raylib::TextureUnmanaged &openedTexture;
+    const CelHandle &closedTexture;
+    const CelHandle &openedTexture;
 public:
-    Door(const Segment *segment, const raylib::TextureUnmanaged &closed_texture, const raylib::TextureUnmanaged &opened_texture, const Entrance &entrance) : Portal(segment, entrance), closedTexture(closed_texture), openedTexture(opened_texture) {
+    Door(const Segment *segment, const CelHandle &closed_texture, const CelHandle &opened_texture, const Entrance &entrance) : Portal(segment, entrance), closedTexture(closed_texture), openedTexture(opened_texture) {
     }
 
     Collision collide() const {
@@ -183,13 +295,21 @@ public:
         return Collision::Block;
     }
 
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&closedTexture, &openedTexture};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return open ? &openedTexture : &closedTexture;
+    }
+
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
 };
 
 class Barricade : public Door {
     DamageType expected;
 public: 
-    Barricade(const Segment *segment, const raylib::TextureUnmanaged &closed_texture, const raylib::TextureUnmanaged &opened_texture, const Entrance &entrance, DamageType expected) : Door(segment, closed_texture, opened_texture, entrance), expected(expected) {
+    Barricade(const Segment *segment, const CelHandle &closed_texture, const CelHandle &opened_texture, const Entrance &entrance, DamageType expected) : Door(segment, closed_texture, opened_texture, entrance), expected(expected) {
     }
 
     Collision collide() const {
@@ -199,27 +319,41 @@ public:
         return Collision::Block;
     }
 
-    std::optional<raylib::RayCollision> collide(const raylib::Ray &ray);
+    std::optional<HitShape> getHitShape() const {
+        if (open)
+            return std::nullopt;
+
+        return HitShape::Quad(x1, y1, x2, y2, 12.0f);
+    }
 
     void damage(Player *player, const DamageType damage_type, int amount) {
         if (damage_type == expected) {
             open = true;
+            setChanged();
         }
     }
 };
 
 class ClosedDoor : public Portal {
 protected:
-    const std::vector<raylib::TextureUnmanaged> &textures;
+    const std::vector<CelHandle> &textures;
     uint32_t frameRate;
 
     size_t frame = 0;
     DoorState state = DoorState::Closed;
+
+    // the frame the opening animation started on
+    std::optional<uint64_t> start;
 public:
-    ClosedDoor(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, uint32_t frame_rate, const Entrance &entrance) : Portal(segment, entrance), textures(textures), frameRate(frame_rate) {
+    ClosedDoor(const Segment *segment, const std::vector<CelHandle> &textures, uint32_t frame_rate, const Entrance &entrance) : Portal(segment, entrance), textures(textures), frameRate(frame_rate) {
     }
 
-    std::optional<raylib::RayCollision> collide(const raylib::Ray &ray);
+    std::optional<HitShape> getHitShape() const {
+        if (state == DoorState::Opened)
+            return std::nullopt;
+
+        return HitShape::Quad(x1, y1, x2, y2, 12.0f);
+    }
 
     Collision collide() const {
         if (state == DoorState::Opened)
@@ -237,6 +371,17 @@ public:
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
     void update(Player *player, uint64_t frame_count);
 
+    // baked like an animated wall, the shader plays the opening once it has a start frame
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&textures[0]};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return &textures[0];
+    }
+
+    std::optional<CelAnimation> getWallAnimation() const;
+
     SegmentType getType() const {
         return SegmentType::Door;
     }
@@ -245,7 +390,7 @@ public:
 class ClosedDoorPlayAnim : public ClosedDoor {
     bool played = false;
 public:
-    ClosedDoorPlayAnim(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, uint32_t frame_rate, const Entrance &entrance) : ClosedDoor(segment, textures, frame_rate, entrance) {
+    ClosedDoorPlayAnim(const Segment *segment, const std::vector<CelHandle> &textures, uint32_t frame_rate, const Entrance &entrance) : ClosedDoor(segment, textures, frame_rate, entrance) {
     }
 
     void touch(Player *player);
@@ -253,7 +398,7 @@ public:
 
 class ElectrifiedFence : public ClosedDoor {
 public:
-    ElectrifiedFence(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, uint32_t frame_rate, const Entrance &entrance) : ClosedDoor(segment, textures, frame_rate, entrance) {
+    ElectrifiedFence(const Segment *segment, const std::vector<CelHandle> &textures, uint32_t frame_rate, const Entrance &entrance) : ClosedDoor(segment, textures, frame_rate, entrance) {
     }
 
     void use(Player *player, std::optional<Item> item_if);
@@ -264,7 +409,7 @@ public:
 class RoomEntry : public Wall {
     State scene;
 public:
-    RoomEntry(const Segment *segment, const raylib::TextureUnmanaged &texture, const State scene) : Wall(segment, texture), scene(scene) {
+    RoomEntry(const Segment *segment, const CelHandle &texture, const State scene) : Wall(segment, texture), scene(scene) {
     }
 
     Collision collide() const {
@@ -279,14 +424,17 @@ public:
 };
 
 class ClosedRoomEntry : public Entity {
-    const std::vector<raylib::TextureUnmanaged> &textures;
+    const std::vector<CelHandle> &textures;
     uint32_t frameRate;
     State scene;
 
     DoorState state = DoorState::Closed;
     size_t frame = 0;
+
+    // the frame the opening animation started on
+    std::optional<uint64_t> start;
 public:
-    ClosedRoomEntry(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, uint32_t frame_rate, const State scene) : Entity(segment), textures(textures), frameRate(frame_rate), scene(scene) {
+    ClosedRoomEntry(const Segment *segment, const std::vector<CelHandle> &textures, uint32_t frame_rate, const State scene) : Entity(segment), textures(textures), frameRate(frame_rate), scene(scene) {
     }
 
     Collision collide() const {
@@ -302,11 +450,27 @@ public:
         }
     }
 
-    std::optional<raylib::RayCollision> collide(const raylib::Ray &ray);
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
     void update(Player *player, uint64_t frame_count);
     void touch(Player *player);
 
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&textures[0]};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return &textures[0];
+    }
+
+    std::optional<CelAnimation> getWallAnimation() const;
+
+    std::optional<HitShape> getHitShape() const {
+        if (state == DoorState::Opened)
+            return std::nullopt;
+
+        return HitShape::Quad(x1, y1, x2, y2, 12.0f);
+    }
+
     SegmentType getType() const {
         return SegmentType::Door;
     }
@@ -316,7 +480,7 @@ public:
 class AnimatedRoomEntry : public AnimatedWall {
     State scene;
 public:
-    AnimatedRoomEntry(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, uint32_t frame_rate, const State scene) : AnimatedWall(segment, textures, frame_rate), scene(scene) {
+    AnimatedRoomEntry(const Segment *segment, const std::vector<CelHandle> &textures, uint32_t frame_rate, const State scene) : AnimatedWall(segment, textures, frame_rate), scene(scene) {
     }
 
     Collision collide() const {
@@ -333,17 +497,18 @@ public:
 class BarricadedRoomEntry : public Entity {
     bool open = false;
 
-    const raylib::TextureUnmanaged &closedTexture;
-    const raylib::TextureUnmanaged &openedTexture;
+    const CelHandle &closedTexture;
+    const CelHandle &openedTexture;
     DamageType expected;
     State scene;
 public:
-    BarricadedRoomEntry(const Segment *segment, const raylib::TextureUnmanaged &closed_texture, const raylib::TextureUnmanaged &opened_texture, DamageType expected, State scene) : Entity(segment), closedTexture(closed_texture), openedTexture(opened_texture), expected(expected), scene(scene) {
+    BarricadedRoomEntry(const Segment *segment, const CelHandle &closed_texture, const CelHandle &opened_texture, DamageType expected, State scene) : Entity(segment), closedTexture(closed_texture), openedTexture(opened_texture), expected(expected), scene(scene) {
     }
 
     void damage(Player *player, const DamageType damage_type, int amount) {
         if (damage_type == expected) {
             open = true;
+            setChanged();
         }
     }
 
@@ -354,9 +519,23 @@ public:
         return Collision::Block;
     }
 
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&closedTexture, &openedTexture};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return open ? &openedTexture : &closedTexture;
+    }
+
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
     void touch(Player *player);
-    std::optional<raylib::RayCollision> collide(const raylib::Ray &ray);
+
+    std::optional<HitShape> getHitShape() const {
+        if (open)
+            return std::nullopt;
+
+        return HitShape::Quad(x1, y1, x2, y2, 12.0f);
+    }
 
     SegmentType getType() const {
         return SegmentType::Door;
@@ -364,10 +543,10 @@ public:
 };
 
 class Prop : public Entity {
-    const raylib::TextureUnmanaged &texture;
+    const CelHandle &texture;
     Collision collision;
 public:
-    Prop(const Segment *segment, const raylib::TextureUnmanaged &texture, Collision collision) : Entity(segment), texture(texture), collision(collision) {
+    Prop(const Segment *segment, const CelHandle &texture, Collision collision) : Entity(segment), texture(texture), collision(collision) {
     }
 
     Collision collide() const {
@@ -375,7 +554,13 @@ public:
     }
 
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
-    std::optional<std::pair<raylib::Vector2, float>> getBounds() const;
+    std::optional<std::pair<raylib::Vector2, float>> getBounds() const {
+        return getSegmentBounds();
+    }
+
+    std::optional<raylib::Vector2> getBillboardPosition() const {
+        return raylib::Vector2(x1, y1);
+    }
 
     SegmentType getType() const {
         return SegmentType::Prop;
@@ -383,16 +568,24 @@ public:
 };
 
 class WallProp : public Entity {
-    const raylib::TextureUnmanaged &texture;
+    const CelHandle &texture;
     Collision collision;
 public:
-    WallProp(const Segment *segment, const raylib::TextureUnmanaged &texture, Collision collision) : Entity(segment), texture(texture), collision(collision) {
+    WallProp(const Segment *segment, const CelHandle &texture, Collision collision) : Entity(segment), texture(texture), collision(collision) {
     }
 
     Collision collide() const {
         return collision;
     }
 
+    std::vector<const CelHandle *> getWallTextures() const {
+        return {&texture};
+    }
+
+    const CelHandle *getWallTexture() const {
+        return &texture;
+    }
+
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
 
     SegmentType getType() const {
@@ -401,8 +594,8 @@ public:
 };
 
 class DamageableProp : public Entity {
-    const raylib::TextureUnmanaged &texture;
-    const raylib::TextureUnmanaged &damaged;
+    const CelHandle &texture;
+    const CelHandle &damaged;
     Collision collision;
 
     bool isDamaged = false;
@@ -410,7 +603,7 @@ class DamageableProp : public Entity {
     raylib::Vector2 position;
     float radius;
 public:
-    DamageableProp(const Segment *segment, const raylib::TextureUnmanaged &texture, const raylib::TextureUnmanaged &damaged, Collision collision) : Entity(segment), texture(texture), damaged(damaged), collision(collision) {
+    DamageableProp(const Segment *segment, const CelHandle &texture, const CelHandle &damaged, Collision collision) : Entity(segment), texture(texture), damaged(damaged), collision(collision) {
         int x = 0;
         int y = 0;
 
@@ -445,8 +638,14 @@ public:
 
     void damage(Player *player, const DamageType damage_type, int amount);
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
-    std::optional<std::pair<raylib::Vector2, float>> getBounds() const;
-    std::optional<raylib::RayCollision> collide(const raylib::Ray &ray);
+    std::optional<std::pair<raylib::Vector2, float>> getBounds() const {
+        return getSegmentBounds();
+    }
+    std::optional<HitShape> getHitShape() const;
+
+    std::optional<raylib::Vector2> getBillboardPosition() const {
+        return raylib::Vector2(x1, y1);
+    }
 
     SegmentType getType() const {
         return SegmentType::Prop;
@@ -454,11 +653,11 @@ public:
 };
 
 class AnimatedProp : public Entity {
-    const std::vector<raylib::TextureUnmanaged> &textures;
+    const std::vector<CelHandle> &textures;
     uint32_t frameRate;
     Collision collision;
 public:
-    AnimatedProp(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, uint32_t frame_rate, Collision collision) : Entity(segment), textures(textures), frameRate(frame_rate), collision(collision) {
+    AnimatedProp(const Segment *segment, const std::vector<CelHandle> &textures, uint32_t frame_rate, Collision collision) : Entity(segment), textures(textures), frameRate(frame_rate), collision(collision) {
     }
 
     Collision collide() const {
@@ -466,7 +665,13 @@ public:
     }
 
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
-    std::optional<std::pair<raylib::Vector2, float>> getBounds() const;
+    std::optional<std::pair<raylib::Vector2, float>> getBounds() const {
+        return getSegmentBounds();
+    }
+
+    std::optional<raylib::Vector2> getBillboardPosition() const {
+        return raylib::Vector2(x1, y1);
+    }
 
     SegmentType getType() const {
         return SegmentType::Prop;
@@ -474,11 +679,11 @@ public:
 };
 
 class Trap : public Entity {
-    const raylib::TextureUnmanaged &texture;
+    const CelHandle &texture;
     DeathType deathType;
     bool triggered = false;
 public:
-    Trap(const Segment *segment, const raylib::TextureUnmanaged &texture, const DeathType death_type) : Entity(segment), texture(texture), deathType(death_type) {
+    Trap(const Segment *segment, const CelHandle &texture, const DeathType death_type) : Entity(segment), texture(texture), deathType(death_type) {
     }
 
     Collision collide() const {
@@ -490,7 +695,13 @@ public:
 
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
     void touch(Player *player);
-    std::optional<std::pair<raylib::Vector2, float>> getBounds() const;
+    std::optional<std::pair<raylib::Vector2, float>> getBounds() const {
+        return getSegmentBounds();
+    }
+
+    std::optional<raylib::Vector2> getBillboardPosition() const {
+        return raylib::Vector2(x1, y1);
+    }
 
     SegmentType getType() const {
         return SegmentType::Trap;
@@ -498,14 +709,14 @@ public:
 };
 
 class ItemPickup : public Entity {
-    const raylib::TextureUnmanaged &texture;
+    const CelHandle &texture;
 
     Item item;
     int count;
 
     bool taken = false;
 public:
-    ItemPickup(const Segment *segment, const raylib::TextureUnmanaged &texture, const Item item, int count) : Entity(segment), texture(texture), item(item), count(count) {
+    ItemPickup(const Segment *segment, const CelHandle &texture, const Item item, int count) : Entity(segment), texture(texture), item(item), count(count) {
         x1 = segment->x1;
         y1 = segment->y1;
         x2 = segment->x2;
@@ -519,11 +730,17 @@ public:
         return Collision::Touch;
     }
 
-    std::optional<std::pair<raylib::Vector2, float>> getBounds() const;
+    std::optional<std::pair<raylib::Vector2, float>> getBounds() const {
+        return getSegmentBounds();
+    }
 
     void draw(const raylib::Camera3D *camera, uint64_t frame_count) const;
     void touch(Player *player);
 
+    std::optional<raylib::Vector2> getBillboardPosition() const {
+        return raylib::Vector2(x1, y1);
+    }
+
     SegmentType getType() const {
         return SegmentType::Item;
     }
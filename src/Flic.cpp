@@ -233,6 +233,8 @@ Flic::Flic(const std::string &filename) : filename(filename) {
     std::array<raylib::Color, 64000> current_frame;
     current_frame.fill(0);
 
+    images.reserve(frames);
+
     for (int i = 0; i < frames; i++) {
         Frame frame(fh);
 
@@ -249,11 +251,11 @@ Flic::Flic(const std::string &filename) : filename(filename) {
             pixels.push_back(pixel.GetA());
         }
 
-        uint8_t *bytes = new uint8_t[pixels.size()];
+        // the Image owns the pixels and releases them with RL_FREE
+        uint8_t *bytes = (uint8_t *)MemAlloc(pixels.size());
         std::memcpy(bytes, pixels.data(), pixels.size());
 
-        auto image = raylib::Image(bytes, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
-        textures.push_back(raylib::TextureUnmanaged(image));
+        images.emplace_back(bytes, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
     }
 }
 
@@ -22,6 +22,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <cstdint>
 #include <array>
 #include <fstream>
+#include <vector>
 
 #include <raylib-cpp.hpp>
 
@@ -73,8 +74,9 @@ class Flic {
     uint16_t flags = 0;
     uint16_t speed = 0;
 
-    std::vector<raylib::TextureUnmanaged> textures;
+    std::vector<raylib::Image> images;
 public:
+    // only decodes, so it can run on the TextureUpload worker
     Flic(const std::string &filename);
 
     uint16_t getWidth() const {
@@ -89,16 +91,17 @@ public:
         return speed;
     }
 
-    const std::vector<raylib::TextureUnmanaged> &getTextures() const {
-        return textures;
+    const std::vector<raylib::Image> &getImages() const {
+        return images;
     }
 
-    const raylib::TextureUnmanaged &getTexture(size_t index) const {
-        return textures[index];
+    // moves the frames out, leaving the Flic empty
+    std::vector<raylib::Image> takeImages() {
+        return std::move(images);
     }
 
     const size_t getFrameCount() const {
-        return textures.size();
+        return images.size();
     }
 
     ~Flic();
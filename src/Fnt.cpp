@@ -22,19 +22,27 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <exception>
 #include <fstream>
 #include <cstring>
+#include <cmath>
+#include <vector>
 
 #include "Fnt.h"
 
-static std::unordered_map<char, raylib::TextureUnmanaged> font_map;
+static const int atlas_columns = 16;
+static const int glyph_advance = 6;
 
-raylib::TextureUnmanaged Fnt::Get(const char c) {
+static raylib::TextureUnmanaged font_atlas;
+static std::vector<raylib::Rectangle> glyphs;
+
+static bool layout_stale = false;
+
+raylib::Rectangle Fnt::GetGlyph(const char c) {
     if (c == ' ')
-        return Fnt::Get('_');
+        return Fnt::GetGlyph('_');
 
-    if (c < '!' || c > 'z')
+    if (c < '!' || c > 'z' || (size_t)(c - '!') >= glyphs.size())
         throw std::out_of_range("Unknown character code " + std::to_string((int)c));
 
-    return font_map[c];
+    return glyphs[c - '!'];
 }
 
 void Fnt::ExtractFonts(const std::string &filename) {
@@ -52,44 +60,137 @@ void Fnt::ExtractFonts(const std::string &filename) {
     fh.read((char *)&char_count, 2);
     fh.read(title.data(), title.size());
 
+    // every glyph goes into one texture so a string is a single batch
+    int atlas_width = atlas_columns * width;
+    int atlas_height = ((char_count + atlas_columns - 1) / atlas_columns) * height;
+
+    std::vector<uint8_t> pixels(atlas_width * atlas_height * 4, 0x00);
+
+    glyphs.clear();
+
     for (int i = 0; i < char_count; i++) {
-        std::vector<uint8_t> pixels;
+        int glyph_x = (i % atlas_columns) * width;
+        int glyph_y = (i / atlas_columns) * height;
 
         for (int j = 0; j < height*width; j++) {
             uint8_t b;
 
             fh.read((char *)&b, 1);
 
+            size_t offset = (((glyph_y + (j / width)) * atlas_width) + glyph_x + (j % width)) * 4;
+
             if (b) {
-                pixels.push_back(0xFF);
-                pixels.push_back(0xFF);
-                pixels.push_back(0xFF);
-                pixels.push_back(0xFF);
-            } else {
-                pixels.push_back(0x00);
-                pixels.push_back(0x00);
-                pixels.push_back(0x00);
-                pixels.push_back(0x00);
+                pixels[offset + 0] = 0xFF;
+                pixels[offset + 1] = 0xFF;
+                pixels[offset + 2] = 0xFF;
+                pixels[offset + 3] = 0xFF;
             }
         }
 
-        auto bytes = new uint8_t[pixels.size()];
-        std::memcpy(bytes, pixels.data(), pixels.size());
+        glyphs.push_back(raylib::Rectangle(glyph_x, glyph_y, width, height));
+    }
+
+    auto bytes = new uint8_t[pixels.size()];
+    std::memcpy(bytes, pixels.data(), pixels.size());
+
+    auto image = raylib::Image(bytes, atlas_width, atlas_height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
 
-        auto image = raylib::Image(bytes, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    font_atlas = raylib::TextureUnmanaged(image);
+    layout_stale = true;
+}
+
+void Fnt::Layout(const std::string &text, int scale, float rotation, std::vector<Quad> &quads) {
+    quads.clear();
+
+    float cos_rotation = std::cos(rotation * DEG2RAD);
+    float sin_rotation = std::sin(rotation * DEG2RAD);
 
-        auto texture = raylib::TextureUnmanaged(image);
+    auto rotate = [&](float x, float y) {
+        return raylib::Vector2(x * cos_rotation - y * sin_rotation, x * sin_rotation + y * cos_rotation);
+    };
+
+    for (size_t i = 0; i < text.size(); i++) {
+        auto glyph = GetGlyph(text[i]);
 
-        font_map[(char)(i + '!')] = texture;
+        // each glyph turns about its own top left corner, like the DrawTextureEx it replaces
+        float x = i * scale * glyph_advance;
+        float width = glyph.width * scale;
+        float height = glyph.height * scale;
+
+        raylib::Vector2 origin(x, 0.0f);
+
+        quads.push_back(Quad(std::array<raylib::Vector2, 4>{
+            origin,
+            origin + rotate(0.0f, height),
+            origin + rotate(width, height),
+            origin + rotate(width, 0.0f),
+        }, raylib::Rectangle(glyph.x / font_atlas.width, glyph.y / font_atlas.height, glyph.width / font_atlas.width, glyph.height / font_atlas.height)));
     }
 }
 
-void Fnt::Write(const std::string &text, int x, int y, int scale, std::optional<raylib::Color> tint, float rotation) {
+void Fnt::Draw(const std::vector<Quad> &quads, int x, int y, std::optional<raylib::Color> tint) {
     if (!tint)
         tint = raylib::Color(0xCF, 0xCD, 0x50, 0xFF);
 
-    for (size_t i = 0; i < text.size(); i++) {
-        auto texture = Fnt::Get(text[i]);
-        texture.Draw(Vector2(x + (i * scale * 6), y), rotation, scale, *tint);
+    rlSetTexture(font_atlas.id);
+    rlBegin(RL_QUADS);
+    {
+        rlColor4ub(tint->r, tint->g, tint->b, tint->a);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+
+        for (const auto &quad : quads) {
+            const float u0 = quad.uv.x;
+            const float u1 = quad.uv.x + quad.uv.width;
+            const float v0 = quad.uv.y;
+            const float v1 = quad.uv.y + quad.uv.height;
+
+            const float texcoords[4][2] = {
+                {u0, v0},
+                {u0, v1},
+                {u1, v1},
+                {u1, v0},
+            };
+
+            for (int corner = 0; corner < 4; corner++) {
+                rlTexCoord2f(texcoords[corner][0], texcoords[corner][1]);
+                rlVertex2f(x + quad.corners[corner].x, y + quad.corners[corner].y);
+            }
+        }
     }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+void Fnt::Write(const std::string &text, int x, int y, int scale, std::optional<raylib::Color> tint, float rotation) {
+    static std::vector<Quad> scratch;
+
+    Layout(text, scale, rotation, scratch);
+    Draw(scratch, x, y, tint);
+}
+
+void Fnt::WriteCached(const std::string &text, int x, int y, int scale, std::optional<raylib::Color> tint, float rotation) {
+    static std::unordered_map<std::string, std::vector<Quad>> layout_cache;
+
+    // cached uvs belong to the previous atlas
+    if (layout_stale) {
+        layout_cache.clear();
+        layout_stale = false;
+    }
+
+    std::string key = text + '\0' + std::to_string(scale) + '\0' + std::to_string(rotation);
+
+    auto cached = layout_cache.find(key);
+
+    if (cached == layout_cache.end()) {
+        // bounded, a string that changes every frame should use Write instead
+        if (layout_cache.size() > 256)
+            layout_cache.clear();
+
+        std::vector<Quad> quads;
+        Layout(text, scale, rotation, quads);
+
+        cached = layout_cache.emplace(key, quads).first;
+    }
+
+    Draw(cached->second, x, y, tint);
 }
@@ -21,15 +21,29 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include <cstdint>
 #include <optional>
+#include <array>
+#include <string>
+#include <vector>
 
 #include <raylib-cpp.hpp>
 
 class Fnt {
+    // one glyph quad relative to the start of the string
+    struct Quad {
+        std::array<raylib::Vector2, 4> corners;
+        raylib::Rectangle uv;
+    };
+
+    static void Layout(const std::string &text, int scale, float rotation, std::vector<Quad> &quads);
+    static void Draw(const std::vector<Quad> &quads, int x, int y, std::optional<raylib::Color> tint);
 public:
-    static raylib::TextureUnmanaged Get(char c);
+    static raylib::Rectangle GetGlyph(char c);
     static void ExtractFonts(const std::string &filename);
     //static void Write(const std::string &text, int x, int y, int scale, raylib::Color tint=raylib::Color(0xCF, 0xCD, 0x50, 0xFF), float rotation=0.0f);
     static void Write(const std::string &text, int x, int y, int scale, std::optional<raylib::Color> tint=std::nullopt, float rotation=0.0f);
+
+    // same as Write, but keeps the layout for strings that are drawn again next frame
+    static void WriteCached(const std::string &text, int x, int y, int scale, std::optional<raylib::Color> tint=std::nullopt, float rotation=0.0f);
 };
 
 #endif //FNT_H
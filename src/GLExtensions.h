@@ -0,0 +1,70 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef GLEXTENSIONS_H
+#define GLEXTENSIONS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// raylib loads these through its bundled glad, rlgl has no wrappers for pixel buffers or fences
+extern "C" {
+    extern void (*glad_glGenBuffers)(int n, unsigned int *buffers);
+    extern void (*glad_glDeleteBuffers)(int n, const unsigned int *buffers);
+    extern void (*glad_glBindBuffer)(unsigned int target, unsigned int buffer);
+    extern void (*glad_glBufferData)(unsigned int target, ptrdiff_t size, const void *data, unsigned int usage);
+    // GL 4.4 or ARB_buffer_storage, raylib only asks for 3.3 so it is not always loaded
+    extern void (*glad_glBufferStorage)(unsigned int target, ptrdiff_t size, const void *data, unsigned int flags);
+    extern void *(*glad_glMapBufferRange)(unsigned int target, ptrdiff_t offset, ptrdiff_t length, unsigned int access);
+    extern unsigned char (*glad_glUnmapBuffer)(unsigned int target);
+    extern void *(*glad_glFenceSync)(unsigned int condition, unsigned int flags);
+    extern unsigned int (*glad_glClientWaitSync)(void *sync, unsigned int flags, uint64_t timeout);
+    extern void (*glad_glDeleteSync)(void *sync);
+    extern void (*glad_glBindTexture)(unsigned int target, unsigned int texture);
+    extern void (*glad_glTexImage2D)(unsigned int target, int level, int internal_format, int width, int height, int border, unsigned int format, unsigned int type, const void *pixels);
+    extern void (*glad_glTexParameteri)(unsigned int target, unsigned int name, int param);
+    extern void (*glad_glTexSubImage2D)(unsigned int target, int level, int x, int y, int width, int height, unsigned int format, unsigned int type, const void *pixels);
+    extern void (*glad_glReadPixels)(int x, int y, int width, int height, unsigned int format, unsigned int type, void *pixels);
+    extern void (*glad_glGenQueries)(int n, unsigned int *ids);
+    extern void (*glad_glBeginQuery)(unsigned int target, unsigned int id);
+    extern void (*glad_glEndQuery)(unsigned int target);
+    extern void (*glad_glGetQueryObjectiv)(unsigned int id, unsigned int name, int *params);
+    extern void (*glad_glGetQueryObjectui64v)(unsigned int id, unsigned int name, uint64_t *params);
+}
+
+static const unsigned int gl_texture_2d = 0x0DE1;
+static const unsigned int gl_texture_max_level = 0x813D;
+static const unsigned int gl_rgba = 0x1908;
+static const unsigned int gl_rgba8 = 0x8058;
+static const unsigned int gl_unsigned_byte = 0x1401;
+static const unsigned int gl_pixel_pack_buffer = 0x88EB;
+static const unsigned int gl_pixel_unpack_buffer = 0x88EC;
+static const unsigned int gl_stream_draw = 0x88E0;
+static const unsigned int gl_stream_read = 0x88E1;
+static const unsigned int gl_map_read_bit = 0x0001;
+static const unsigned int gl_map_write_bit = 0x0002;
+static const unsigned int gl_map_invalidate_buffer_bit = 0x0008;
+static const unsigned int gl_map_persistent_bit = 0x0040;
+static const unsigned int gl_map_coherent_bit = 0x0080;
+static const unsigned int gl_sync_gpu_commands_complete = 0x9117;
+static const unsigned int gl_timeout_expired = 0x911B;
+static const unsigned int gl_time_elapsed = 0x88BF;
+static const unsigned int gl_query_result = 0x8866;
+static const unsigned int gl_query_result_available = 0x8867;
+
+#endif //GLEXTENSIONS_H
@@ -29,9 +29,13 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Player.h"
 #include "Fnt.h"
 #include "Panel.h"
+#include "UiLayer.h"
 
 class Help {
     Panel *panel;
+
+    // the key list never changes, only redrawn on a scale change
+    UiLayer layer;
 public: 
     Help(Panel *panel);
     void draw(Player *player, raylib::Window &window, int scale);
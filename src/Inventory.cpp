@@ -19,10 +19,11 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Inventory.h"
 #include "StillCel.h"
 #include "Strings.h"
+#include "Screen.h"
 
 #include <iostream>
 
-Inventory::Inventory(Panel *panel) : panel(panel) {
+Inventory::Inventory(Panel *panel) : panel(panel), layer(raylib::Rectangle(0, 0, 320, 138)) {
     background = StillCel("stillcel/invbkg.cel").getTexture(); 
 
     itemLayouts.emplace(Item::Raft, Layout(raylib::Vector2(252, 3), StillCel("stillcel/rafti.cel").getTexture(), Strings::Lookup(432), Strings::Lookup(433)));
@@ -79,17 +80,22 @@ void Inventory::draw(Player *player, int scale) {
     const static std::string USE = Strings::Lookup(184);
     const static std::string USE_ON = Strings::Lookup(197);
 
-    BeginDrawing();
-    {
+    layer.update(player->getUiRevision(), scale, [this, player, scale]() {
         background.Draw(Vector2(0, 0), 0.0f, scale);
 
         for (const auto &[item, layout] : itemLayouts) {
             int item_count = player->getItemCount(item);
 
             if (item_count) {
-                itemLayouts[item].draw(scale, item_count);
+                layout.draw(scale, item_count);
             }
         }
+    });
+    panel->update(player, scale);
+
+    Screen::BeginFrame();
+    {
+        layer.draw();
 
         uint64_t player_input = player->getInput();
 
@@ -210,9 +216,9 @@ void Inventory::draw(Player *player, int scale) {
             scale_border.DrawLines(raylib::PURPLE, scale);
         }
 
-        panel->draw(player, player->getHighlight(), scale);
+        panel->draw(player, scale);
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 Inventory::~Inventory() {
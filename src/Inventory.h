@@ -29,6 +29,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Player.h"
 #include "Fnt.h"
 #include "Panel.h"
+#include "UiLayer.h"
 
 class Inventory {
     struct Layout {
@@ -57,6 +58,9 @@ class Inventory {
 
     std::unordered_map<Item, Layout> itemLayouts;
     Panel *panel;
+
+    // background and held items, redrawn when the player's items change
+    UiLayer layer;
 public: 
     Inventory(Panel *panel);
     void draw(Player *player, int scale);
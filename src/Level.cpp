@@ -20,13 +20,16 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <array>
 #include <unordered_map>
 #include <tuple>
+#include <chrono>
 
 #include "Fnt.h"
 #include "Level.h"
 #include "Player.h"
 #include "StillCel.h"
+#include "RenderQueue.h"
+#include "Screen.h"
 
-Level::Level(const LevelSettings &level_settings) : map(level_settings.filename), music(level_settings.music) {
+Level::Level(const LevelSettings &level_settings) : map(level_settings.filename), culling(map), music(level_settings.music) {
     size_t width = map.getWidth() / 10 + 1;
     size_t height = map.getHeight() / 10 + 1;
 
@@ -42,19 +45,24 @@ Level::Level(const LevelSettings &level_settings) : map(level_settings.filename)
         grid(x, y) = 1;
     }
 
+    // enclosed levels fog in close, their flat sky colour already hides anything further
     switch (level_settings.sky) {
         case Sky::Day:
             sky = raylib::Color(0x0C, 0x14, 0x51, 0xFF);
+            fog = RenderQueue::Fog(sky, 250.0f, 600.0f);
             showSkyOrMoon = true;
             break;
         case Sky::Cave:
             sky = raylib::Color(0x30, 0x20, 0x20, 0xFF);
+            fog = RenderQueue::Fog(sky, 60.0f, 200.0f);
             break;
         case Sky::Basement:
             sky = raylib::Color(0x94, 0x94, 0x94, 0xFF);
+            fog = RenderQueue::Fog(sky, 100.0f, 300.0f);
             break;
         case Sky::Mansion:
             sky = raylib::Color(0x59, 0x48, 0x2C, 0xFF);
+            fog = RenderQueue::Fog(sky, 100.0f, 300.0f);
             break;
 
     }
@@ -78,6 +86,14 @@ Level::Level(const LevelSettings &level_settings) : map(level_settings.filename)
     }
 }
 
+void Level::update(Player *player, const uint64_t frame_count) {
+    for (const auto &entry : spatialIndex->getEntries()) {
+        entry.entity->update(player, frame_count);
+    }
+
+    spatialIndex->update();
+}
+
 void Level::draw(Player *player, raylib::Window &window, const uint64_t frame_count, const int scale) {
     static const Palette palette("cels3/palette.pal");
 
@@ -89,38 +105,102 @@ void Level::draw(Player *player, raylib::Window &window, const uint64_t frame_co
     auto *map = level->getMap();
     auto *camera = player->getCamera();
 
-    BeginDrawing();
+    // built on a worker the first time the level is shown, until it lands nothing is culled by it
+    if (!visibilitySet) {
+        if (!pendingVisibilitySet.valid())
+            pendingVisibilitySet = VisibilitySet::Start(this->map, world);
+        else if (pendingVisibilitySet.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            visibilitySet = pendingVisibilitySet.get();
+    }
+
+    size_t chunks_drawn = 0;
+
+    auto &automap = world->getAutomap();
+
+    if (automap.isOverlay())
+        automap.update(world, map, scale);
+
+    Screen::BeginFrame();
     {
         window.ClearBackground(sky);
 
-        map->sortSegments(camera, world);
+        RenderQueue::SetFrameCounter(frame_count);
 
-        camera->BeginMode();
-        {
-            DrawPlane(Vector3(0.0, 0.0, 0.0), Vector2(1000, 1000), ground);
+        if (softwareRenderer) {
+            const uint64_t *potentially_visible = visibilitySet ? visibilitySet->getRow(camera->GetPosition()) : nullptr;
 
-            rlColor4ub(0xFF, 0xFF, 0xFF, 0xFF);
+            // every wall and sprite goes to the raycaster, which does its own occlusion
+            RenderQueue::SetSoftwareTarget(softwareRenderer.get());
 
             for (const auto &segment : map->getSegments()) {
                 auto entity = world->getEntity(segment.id);
 
-                if (entity) {
+                if (!entity)
+                    continue;
+
+                if (!entity->getPosition() && potentially_visible && !VisibilitySet::Test(potentially_visible, segment.index))
+                    continue;
+
+                entity->draw(camera, frame_count);
+            }
+
+            RenderQueue::SetSoftwareTarget(nullptr);
+
+            softwareRenderer->render(camera, sky, ground, drawDistance);
+            softwareRenderer->draw(scale);
+        } else {
+            camera->BeginMode();
+            {
+                const uint64_t *potentially_visible = visibilitySet ? visibilitySet->getRow(camera->GetPosition()) : nullptr;
+
+                const auto level_fog = getFog();
+                RenderQueue::SetFog(level_fog, camera->GetPosition());
+
+                // nothing past the fog end can show, so it doubles as the far cull distance
+                Frustum frustum(camera, level_fog.end);
+
+                // the ground fades to the sky colour along with the walls
+                BeginShaderMode(RenderQueue::GetOpaqueShader());
+                DrawPlane(Vector3(0.0, 0.0, 0.0), Vector2(1000, 1000), ground);
+                EndShaderMode();
+
+                rlDrawRenderBatchActive();
+
+                // opaque walls front to back with depth writes, then alpha tested walls
+                if (staticGeometry) {
+                    staticGeometry->update(potentially_visible, frame_count);
+                    chunks_drawn += staticGeometry->drawOpaque(camera, frustum);
+                    chunks_drawn += staticGeometry->drawAlphaTested(frustum);
+                }
+
+                // transparent pass, everything that is not a baked wall, only from the subtrees in view
+                const auto &segments = map->getSegments();
+                const auto &in_view = map->getInView(frustum);
+
+                culling.update(frustum, potentially_visible, in_view);
+
+                for (auto i : in_view) {
+                    auto entity = world->getEntity(segments[i].id);
+
+                    if (!entity || !culling.isVisible(frustum, segments[i], entity))
+                        continue;
+
                     entity->draw(camera, frame_count);
                 }
 
-                rlDrawRenderBatchActive();
-            }
+                RenderQueue::Flush();
 
-            if (showSkyOrMoon) {
-                raylib::Vector3 position(-400, 100, -400);
+                if (showSkyOrMoon) {
+                    raylib::Vector3 position(-400, 100, -400);
 
-                if (player->testFlag(Flag::BombCountdown))
-                    camera->DrawBillboard(moon, position, scale*10);
-                else
-                    camera->DrawBillboard(sun, position, scale*10);
+                    if (player->testFlag(Flag::BombCountdown))
+                        camera->DrawBillboard(moon, position, scale*10);
+                    else
+                        camera->DrawBillboard(sun, position, scale*10);
+                }
             }
+            camera->EndMode();
         }
-        camera->EndMode();
 
         player->drawWeapon(frame_count, scale);
 
@@ -149,8 +229,33 @@ void Level::draw(Player *player, raylib::Window &window, const uint64_t frame_co
 
             Fnt::Write(ammo_count, (320-(ammo_count.size()*6))*scale, (200-10) * scale, scale);
         }
+
+        if (automap.isOverlay()) {
+            const float size = 80.0f;
+
+            // same cached layer as the map screen, scaled into the top right corner
+            auto area = automap.draw(raylib::Rectangle((320 - size) * scale, 0.0f, size * scale, size * scale));
+            float factor = area.width / automap.getWidth();
+
+            DrawCircleV(raylib::Vector2(area.x, area.y) + automap.toLayer(player->getPosition()) * factor, std::max(1.0f, Automap::MapScale * scale * 3 * factor), raylib::BLUE);
+        }
+
+        if (world->getShowStats()) {
+            size_t segment_count = culling.getVisibleCount() + culling.getCulledCount() + map->getCulledCount();
+            size_t chunk_count = staticGeometry ? staticGeometry->getBatchCount() : 0;
+
+            Fnt::Write("SEGMENTS " + std::to_string(culling.getVisibleCount()) + "/" + std::to_string(segment_count), 0, 0, scale);
+            Fnt::Write("CHUNKS " + std::to_string(chunks_drawn) + "/" + std::to_string(chunk_count), 0, 10 * scale, scale);
+            const auto &queue_stats = RenderQueue::GetStats();
+
+            Fnt::Write("QUEUE " + std::to_string(queue_stats.items) + "/" + std::to_string(queue_stats.stateChanges), 0, 20 * scale, scale);
+            Fnt::Write("SPRITES " + std::to_string(queue_stats.billboards) + "/" + std::to_string(queue_stats.instancedDraws), 0, 30 * scale, scale);
+
+            if (softwareRenderer)
+                Fnt::Write("SOFTWARE " + std::to_string(softwareRenderer->getWallCount()) + "/" + std::to_string(softwareRenderer->getSpriteCount()) + "/" + std::to_string(softwareRenderer->getCellsVisited()), 0, 40 * scale, scale);
+        }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 std::vector<Level::Node> Level::findPathNodes(const Level::Node &start, const Level::Node &goal) {
@@ -23,6 +23,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <cstdint>
 #include <array>
 #include <memory>
+#include <future>
 #include <optional>
 #include <iostream>
 
@@ -32,6 +33,12 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Map.h"
 #include "Entrance.h"
 #include "Entity.h"
+#include "StaticGeometry.h"
+#include "Culling.h"
+#include "VisibilitySet.h"
+#include "SoftwareRenderer.h"
+#include "RenderQueue.h"
+#include "SpatialIndex.h"
 
 struct LevelSettings {
     const std::string filename;
@@ -129,12 +136,24 @@ class Level {
     };
 
     Map map;
+    Culling culling;
     Grid grid;
 
+    std::unique_ptr<StaticGeometry> staticGeometry;
+    std::unique_ptr<VisibilitySet> visibilitySet;
+
+    // after map, so the worker is waited on before the map it reads is destroyed
+    std::future<std::unique_ptr<VisibilitySet>> pendingVisibilitySet;
+
+    std::unique_ptr<SoftwareRenderer> softwareRenderer;
+    std::unique_ptr<SpatialIndex> spatialIndex;
+    float drawDistance = 0.0f;
+
     std::vector<Node> findPathNodes(const Node &start, const Node &goal);
 
     raylib::Color sky;
     raylib::Color ground;
+    RenderQueue::Fog fog;
 
     std::string music;
     bool showSkyOrMoon = false;
@@ -152,6 +171,51 @@ public:
         music = new_music;
     }
 
+    // 0 leaves the fog end as the limit, anything shorter pulls the fog in with it
+    void setDrawDistance(float new_draw_distance) {
+        drawDistance = new_draw_distance;
+    }
+
+    // fog actually drawn, its end is where walls and sprites are culled
+    RenderQueue::Fog getFog() const {
+        if (drawDistance > 0.0f && drawDistance < fog.end)
+            return RenderQueue::Fog(fog.colour, fog.start * drawDistance / fog.end, drawDistance);
+
+        return fog;
+    }
+
+    // raycasts the level on the CPU instead of drawing it with the GPU
+    void setSoftwareRendering(bool enabled) {
+        if (enabled && !softwareRenderer)
+            softwareRenderer = std::make_unique<SoftwareRenderer>(map);
+        else if (!enabled)
+            softwareRenderer.reset();
+    }
+
+    // needs the spawned entities, so runs once the world has populated every level
+    void bake(World *world) {
+        map.buildTree(world);
+        staticGeometry = std::make_unique<StaticGeometry>(map, world);
+        spatialIndex = std::make_unique<SpatialIndex>(map, world);
+    }
+
+    SpatialIndex *getSpatialIndex() {
+        return spatialIndex.get();
+    }
+
+    // what a shot or a use along the ray reaches, nearest first up to the first thing that blocks
+    std::vector<SpatialIndex::Hit> castRay(const raylib::Ray &ray, float range) const {
+        return spatialIndex->castRay(ray, range);
+    }
+
+    // nearest hit for each ray, for spread shots and anything else that covers an area
+    std::vector<std::optional<SpatialIndex::Hit>> castPacket(const RayPacket &packet, float range) const {
+        return spatialIndex->castPacket(packet, range);
+    }
+
+    // runs every entity, then re-buckets the ones that moved
+    void update(Player *player, const uint64_t frame_count);
+
     void draw(Player *player, raylib::Window &window, const uint64_t frame_count, const int scale);
 
     std::vector<raylib::Vector2> findPath(const raylib::Vector2 &start, const raylib::Vector2 &goal);
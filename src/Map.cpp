@@ -25,6 +25,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <unordered_map>
 
 #include "Map.h"
+#include "Culling.h"
 #include "Entity.h"
 #include "World.h"
 
@@ -63,7 +64,7 @@ Map::Map(const std::string &filename) : filename(filename), x(0), y(0), width(0)
     size_t map_hash_id = std::hash<std::string>{}(filename);
 
     size_t segment_id = map_hash_id ^ hash_map_segment(map_segment);
-    segments.push_back(Segment(segment_id, map_segment.x1, map_segment.y1, map_segment.x2, map_segment.y2, map_segment.footer, map_segment._flags5, map_segment.count));
+    segments.push_back(Segment(segment_id, map_segment.x1, map_segment.y1, map_segment.x2, map_segment.y2, map_segment.footer, map_segment._flags5, map_segment.count, segments.size()));
 
     size_t segment_count = map_segment.count-1;
 
@@ -71,84 +72,281 @@ Map::Map(const std::string &filename) : filename(filename), x(0), y(0), width(0)
         fh.read((char *)&map_segment, sizeof(map_segment));
         size_t segment_id = map_hash_id ^ hash_map_segment(map_segment);
 
-        segments.push_back(Segment(segment_id, map_segment.x1, map_segment.y1, map_segment.x2, map_segment.y2, map_segment.footer, map_segment._flags5, map_segment.count));
+        segments.push_back(Segment(segment_id, map_segment.x1, map_segment.y1, map_segment.x2, map_segment.y2, map_segment.footer, map_segment._flags5, map_segment.count, segments.size()));
 
         x = std::min(x, std::min(map_segment.x1, map_segment.x2));
         y = std::min(y, std::min(map_segment.y1, map_segment.y2));
         width = std::max(width, std::max(map_segment.x1, map_segment.x2));
         height = std::max(height, std::max(map_segment.y1, map_segment.y2));
     }
+
+    for (const auto &segment : segments) {
+        segmentArrays.push_back(segment);
+    }
 }
 
-void Map::sortSegments(const raylib::Camera3D *camera, World *world) {
-    std::sort(std::begin(segments), std::end(segments), [camera, world](const Segment &l, const Segment &r) {
-        auto camera_position = camera->GetPosition();
-        camera_position.y = 0;
+// billboards per leaf before it is split again, smaller leaves are skipped more often
+static const size_t leaf_billboards = 4;
 
-        // special case for fence/tank rendering
-        if (l.texture != 63 && r.texture != 63) {
-            if (l.texture < 100 && r.texture >= 100)
-                return true;
+int32_t Map::buildNode(std::vector<uint32_t> walls, std::vector<Billboard> billboards, const raylib::Rectangle &area) {
+    int32_t index = nodes.size();
+    nodes.push_back(Node(false, 0.0f, -1, -1, {}, {}, {}, Culling::GetAreaBounds(area), (uint32_t)(walls.size() + billboards.size())));
 
-            if (r.texture < 100 && l.texture >= 100)
-                return false;
-        }
+    if (walls.empty() && billboards.size() <= leaf_billboards) {
+        nodes[index].billboards = billboards;
+        return index;
+    }
 
-        Entity *le = world->getEntity(l.id);
-        Entity *re = world->getEntity(r.id);
+    // which side of a split line a wall is on, 0 when on or across it
+    auto side = [this](uint32_t wall, bool vertical, float split) {
+        const auto &segment = segments[wall];
 
-        Vector3 l_segment_position(0.0f, 0.0f, 0.0f);
-        Vector3 r_segment_position(0.0f, 0.0f, 0.0f);
+        float low = vertical ? std::min(segment.x1, segment.x2) : std::min(segment.y1, segment.y2);
+        float high = vertical ? std::max(segment.x1, segment.x2) : std::max(segment.y1, segment.y2);
 
-        if (!le) {
-            uint16_t min_x = std::min(l.x1, l.x2);
-            uint16_t max_x = std::max(l.x1, l.x2);
-            uint16_t min_y = std::min(l.y1, l.y2);
-            uint16_t max_y = std::max(l.y1, l.y2);
+        if (high <= split && low < split)
+            return -1;
+        if (low >= split && high > split)
+            return 1;
 
-            l_segment_position = Vector3((max_x-min_x)/2 + min_x, 0, (max_y - min_y)/2 + min_y);
-        } else {
-            auto position_if = le->getPosition();
+        return 0;
+    };
+
+    bool vertical = false;
+    float split = 0.0f;
+
+    if (!walls.empty()) {
+        // autopartition, the wall whose line cuts the fewest others and leaves the sides most even
+        std::optional<size_t> best_score;
+
+        for (auto candidate : walls) {
+            const auto &segment = segments[candidate];
+
+            bool candidate_vertical = segment.x1 == segment.x2;
+            float candidate_split = candidate_vertical ? segment.x1 : segment.y1;
+
+            int cut = 0;
+            int balance = 0;
 
-            if (position_if) {
-                l_segment_position = Vector3(position_if->x, 0, position_if->y);
-            } else {
-                uint16_t min_x = std::min(l.x1, l.x2);
-                uint16_t max_x = std::max(l.x1, l.x2);
-                uint16_t min_y = std::min(l.y1, l.y2);
-                uint16_t max_y = std::max(l.y1, l.y2);
+            for (auto wall : walls) {
+                int wall_side = side(wall, candidate_vertical, candidate_split);
 
-                l_segment_position = Vector3((max_x-min_x)/2 + min_x, 0, (max_y - min_y)/2 + min_y);
+                if (wall_side == 0 && wall != candidate) {
+                    const auto &other = segments[wall];
+                    bool on_line = (other.x1 == other.x2) == candidate_vertical && (candidate_vertical ? other.x1 : other.y1) == candidate_split;
+
+                    if (!on_line)
+                        cut++;
+                }
+
+                balance += wall_side;
+            }
+
+            for (const auto &billboard : billboards) {
+                balance += (candidate_vertical ? billboard.position.x : billboard.position.y) < candidate_split ? -1 : 1;
+            }
+
+            size_t score = cut * 8 + std::abs(balance);
+
+            if (!best_score || score < *best_score) {
+                best_score = score;
+                vertical = candidate_vertical;
+                split = candidate_split;
             }
         }
+    } else {
+        // only billboards left, split at the median along the wider axis
+        auto split_axis = [&billboards](bool axis_vertical) -> std::optional<float> {
+            std::vector<float> coordinates;
+
+            for (const auto &billboard : billboards) {
+                coordinates.push_back(axis_vertical ? billboard.position.x : billboard.position.y);
+            }
+
+            std::sort(std::begin(coordinates), std::end(coordinates));
+
+            // the split must leave something on the less side
+            auto median = std::begin(coordinates) + coordinates.size() / 2;
+
+            if (*median == coordinates.front())
+                median = std::upper_bound(median, std::end(coordinates), coordinates.front());
+
+            if (median == std::end(coordinates))
+                return std::nullopt;
+
+            return *median;
+        };
+
+        float min_x = billboards.front().position.x;
+        float max_x = min_x;
+        float min_y = billboards.front().position.y;
+        float max_y = min_y;
+
+        for (const auto &billboard : billboards) {
+            min_x = std::min(min_x, billboard.position.x);
+            max_x = std::max(max_x, billboard.position.x);
+            min_y = std::min(min_y, billboard.position.y);
+            max_y = std::max(max_y, billboard.position.y);
+        }
+
+        vertical = max_x - min_x >= max_y - min_y;
+        auto split_if = split_axis(vertical);
+
+        if (!split_if) {
+            vertical = !vertical;
+            split_if = split_axis(vertical);
+        }
+
+        // every billboard on one spot, nothing left to split
+        if (!split_if) {
+            nodes[index].billboards = billboards;
+            return index;
+        }
+
+        split = *split_if;
+    }
+
+    std::vector<uint32_t> less_walls;
+    std::vector<uint32_t> greater_walls;
+    std::vector<Billboard> less_billboards;
+    std::vector<Billboard> greater_billboards;
+
+    for (auto wall : walls) {
+        int wall_side = side(wall, vertical, split);
+
+        if (wall_side < 0)
+            less_walls.push_back(wall);
+        else if (wall_side > 0)
+            greater_walls.push_back(wall);
+        else
+            nodes[index].walls.push_back(wall);
+    }
+
+    for (const auto &billboard : billboards) {
+        if ((vertical ? billboard.position.x : billboard.position.y) < split)
+            less_billboards.push_back(billboard);
+        else
+            greater_billboards.push_back(billboard);
+    }
+
+    // both children always exist, so a moving billboard always lands in a leaf
+    raylib::Rectangle less_area = area;
+    raylib::Rectangle greater_area = area;
+
+    if (vertical) {
+        less_area.width = split - area.x;
+        greater_area.x = split;
+        greater_area.width = area.x + area.width - split;
+    } else {
+        less_area.height = split - area.y;
+        greater_area.y = split;
+        greater_area.height = area.y + area.height - split;
+    }
+
+    int32_t less = buildNode(less_walls, less_billboards, less_area);
+    int32_t greater = buildNode(greater_walls, greater_billboards, greater_area);
+
+    nodes[index].vertical = vertical;
+    nodes[index].split = split;
+    nodes[index].less = less;
+    nodes[index].greater = greater;
+
+    return index;
+}
+
+void Map::buildTree(World *world) {
+    std::vector<uint32_t> walls;
+    std::vector<Billboard> billboards;
+
+    nodes.clear();
+    movingEntities.clear();
+
+    for (uint32_t i = 0; i < segments.size(); i++) {
+        Entity *entity = world->getEntity(segments[i].id);
 
-        if (!re) {
-            uint16_t min_x = std::min(r.x1, r.x2);
-            uint16_t max_x = std::max(r.x1, r.x2);
-            uint16_t min_y = std::min(r.y1, r.y2);
-            uint16_t max_y = std::max(r.y1, r.y2);
+        // baked walls are culled and drawn by StaticGeometry
+        if (!entity || entity->getWallTexture())
+            continue;
 
-            r_segment_position = Vector3((max_x-min_x)/2 + min_x, 0, (max_y - min_y)/2 + min_y);
+        if (entity->getPosition()) {
+            movingEntities.push_back(std::make_pair(i, entity));
+        } else if (auto position = entity->getBillboardPosition()) {
+            billboards.push_back(Billboard(i, *position));
         } else {
-            auto position_if = re->getPosition();
+            walls.push_back(i);
+        }
+    }
 
-            if (position_if) {
-                r_segment_position = Vector3(position_if->x, 0, position_if->y);
-            } else {
-                uint16_t min_x = std::min(r.x1, r.x2);
-                uint16_t max_x = std::max(r.x1, r.x2);
-                uint16_t min_y = std::min(r.y1, r.y2);
-                uint16_t max_y = std::max(r.y1, r.y2);
+    buildNode(walls, billboards, raylib::Rectangle(x, y, width - x, height - y));
+}
 
-                r_segment_position = Vector3((max_x-min_x)/2 + min_x, 0, (max_y - min_y)/2 + min_y);
-            }
+int32_t Map::findLeaf(const raylib::Vector2 &position) const {
+    int32_t node = 0;
+
+    while (nodes[node].less >= 0) {
+        const auto &current = nodes[node];
+        node = (current.vertical ? position.x : position.y) < current.split ? current.less : current.greater;
+    }
+
+    return node;
+}
+
+void Map::traverse(int32_t node, const Frustum &frustum) {
+    auto &current = nodes[node];
+
+    // none of the segments in here are tested one by one, moving billboards left behind are cleared next frame
+    if (!frustum.containsBox(current.bounds)) {
+        culledCount += current.count;
+        return;
+    }
+
+    if (current.less < 0) {
+        for (const auto &billboard : current.billboards) {
+            inView.push_back(billboard.segment);
         }
 
-        float l_dist = Vector3Distance(camera_position, l_segment_position);
-        float r_dist = Vector3Distance(camera_position, r_segment_position);
+        for (const auto &billboard : current.moving) {
+            inView.push_back(billboard.segment);
+        }
+
+        current.moving.clear();
+        return;
+    }
+
+    for (auto wall : current.walls) {
+        inView.push_back(wall);
+    }
+
+    traverse(current.less, frustum);
+    traverse(current.greater, frustum);
+}
+
+const std::vector<uint32_t> &Map::getInView(const Frustum &frustum) {
+    inView.clear();
+    culledCount = 0;
+
+    for (auto leaf : movingLeaves) {
+        nodes[leaf].moving.clear();
+    }
+
+    movingLeaves.clear();
+
+    if (nodes.empty())
+        return inView;
+
+    for (const auto &[segment, entity] : movingEntities) {
+        auto entity_position = *entity->getPosition();
+        int32_t leaf = findLeaf(entity_position);
+
+        if (nodes[leaf].moving.empty())
+            movingLeaves.push_back(leaf);
+
+        nodes[leaf].moving.push_back(Billboard(segment, entity_position));
+    }
+
+    traverse(0, frustum);
 
-        return r_dist < l_dist;
-    }); 
+    return inView;
 }
 
 Map::~Map() {
@@ -23,16 +23,60 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <array>
 #include <exception>
 #include <string>
+#include <vector>
+#include <optional>
 
 #include <raylib-cpp.hpp>
 
 #include "Segment.h"
 
 class World;
+class Entity;
+class Frustum;
 
 class Map {
+    // Axis aligned BSP over the segments StaticGeometry does not bake, used to skip whole areas outside the frustum.
+    // Walls split space and are kept at the node that splits them, billboards sit in leaves that are split further
+    // around their positions.
+    struct Billboard {
+        uint32_t segment;
+        raylib::Vector2 position;
+    };
+
+    struct Node {
+        // x == split when vertical, else y == split
+        bool vertical;
+        float split;
+        int32_t less;
+        int32_t greater;
+
+        // on or across the split line
+        std::vector<uint32_t> walls;
+
+        // leaves only, moving ones are refilled every frame
+        std::vector<Billboard> billboards;
+        std::vector<Billboard> moving;
+
+        // the area the node splits, padded like Culling::GetSegmentBounds, and the segments that never move inside it
+        BoundingBox bounds;
+        uint32_t count;
+    };
+
     const std::string filename;
     std::vector<Segment> segments;
+    SegmentArrays segmentArrays;
+
+    std::vector<Node> nodes;
+    std::vector<std::pair<uint32_t, Entity *>> movingEntities;
+    std::vector<uint32_t> inView;
+
+    // leaves that were given moving billboards last frame
+    std::vector<int32_t> movingLeaves;
+    size_t culledCount = 0;
+
+    int32_t buildNode(std::vector<uint32_t> walls, std::vector<Billboard> billboards, const raylib::Rectangle &area);
+    int32_t findLeaf(const raylib::Vector2 &position) const;
+    void traverse(int32_t node, const Frustum &frustum);
 
     uint16_t x;
     uint16_t y;
@@ -45,6 +89,10 @@ public:
         return segments;
     }
 
+    const SegmentArrays &getSegmentArrays() const {
+        return segmentArrays;
+    }
+
     uint16_t getX() const {
         return x;
     }
@@ -65,7 +113,17 @@ public:
         return filename;
     }
 
-    void sortSegments(const raylib::Camera3D *camera, World *world);
+    // needs the spawned entities to tell baked walls, walls and billboards apart
+    void buildTree(World *world);
+
+    // segment indices of everything StaticGeometry does not draw, in no particular order since RenderQueue sorts by
+    // state and everything is depth tested. Subtrees outside the frustum are skipped whole.
+    const std::vector<uint32_t> &getInView(const Frustum &frustum);
+
+    // segments that never move left out of the last view with their subtree
+    size_t getCulledCount() const {
+        return culledCount;
+    }
 
     ~Map();
 };
@@ -21,47 +21,18 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Player.h"
 #include "Monster.h"
 #include "SoundCache.h"
+#include "RenderQueue.h"
 
 using namespace Monster;
 
-static void draw_entity(const raylib::Camera3D *camera, const raylib::Vector2 &position, const raylib::TextureUnmanaged &texture) {
+static void draw_entity(const raylib::Camera3D *camera, const raylib::Vector2 &position, const CelHandle &texture) {
     const float y_offset = 5.0f;
     const float scale = 10.0f;
 
-
-    static const char *fragment_shader = R"(
-#version 330
-
-// Input vertex attributes (from vertex shader)
-in vec2 fragTexCoord;
-in vec4 fragColor;
-
-// Input uniform values
-uniform sampler2D texture0;
-uniform vec4 colDiffuse;
-
-// Output fragment color
-out vec4 finalColor;
-
-void main()
-{
-    vec4 texelColor = texture(texture0, fragTexCoord);
-    if (texelColor.a == 0.0) discard;
-    finalColor = texelColor * fragColor * colDiffuse;
+    RenderQueue::SubmitBillboard(Vector3(position.GetX(), y_offset, position.GetY()), scale, texture);
 }
-    )";
-
-    static raylib::ShaderUnmanaged shader = raylib::ShaderUnmanaged::LoadFromMemory(nullptr, fragment_shader);
 
-    shader.BeginMode();
-    {
-        camera->DrawBillboard(texture, Vector3(position.GetX(), y_offset, position.GetY()), scale);
-    }
-    shader.EndMode();
-
-}
-
-Base::Base(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, const float step_size, const DeathType death_type, const int attack_damage, float notice_distance, float attack_distance, float walk_distance) : Entity(segment), textures(textures), stepSize(step_size), deathType(death_type), attackDamage(attack_damage), noticeDistance(notice_distance), attackDistance(attack_distance), walkDistance(walk_distance) {
+Base::Base(const Segment *segment, const std::vector<CelHandle> &textures, const float step_size, const DeathType death_type, const int attack_damage, float notice_distance, float attack_distance, float walk_distance) : Entity(segment), textures(textures), stepSize(step_size), deathType(death_type), attackDamage(attack_damage), noticeDistance(notice_distance), attackDistance(attack_distance), walkDistance(walk_distance) {
     int x = 0;
     int y = 0;
 
@@ -199,24 +170,21 @@ void Base::damage(Player *player, const DamageType damage_type, int amount) {
     }
 }
 
-std::optional<raylib::RayCollision> Base::collide(const raylib::Ray &ray) {
-    if (collide() == Collision::Pass)
+std::optional<HitShape> Base::getHitShape() const {
+    // a body left to be picked up is only touched, shots go past it
+    if (collide() != Collision::Block)
         return std::nullopt;
 
-    const float height = 6.0f; 
-
-    auto collision = ray.GetCollision(raylib::Vector3(position.GetX(), height, position.GetY()), height);
-    if (collision.GetDistance())
-        return collision;
+    const float height = 6.0f;
 
-    return std::nullopt;
+    return HitShape::Sphere(raylib::Vector3(position.GetX(), height, position.GetY()), height);
 }
 
 Base::~Base() {
 
 }
 
-Bat::Bat(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Bat, 2, 50.f, 20.0f, 200.0f) {
+Bat::Bat(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Bat, 2, 50.f, 20.0f, 200.0f) {
     health = 5;
     state = MonsterState::Asleep;
 
@@ -234,7 +202,7 @@ Bat::Bat(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &te
     currentFrame = std::get<0>(stateFrames[state]);
 }
 
-CJ::CJ(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
+CJ::CJ(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
     health = 30;
     state = MonsterState::Asleep;
 
@@ -255,7 +223,7 @@ CJ::CJ(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &text
     currentFrame = std::get<0>(stateFrames[state]);
 }
 
-Doc::Doc(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Doc, 4, 50.f, 20.0f, 200.0f) {
+Doc::Doc(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Doc, 4, 50.f, 20.0f, 200.0f) {
     health = 100;
     state = MonsterState::Standing;
 
@@ -300,7 +268,7 @@ void Doc::onDeath(Player *player) {
     player->setState(State::DocDie);
 }
 
-Dude::Dude(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
+Dude::Dude(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
     health = 30;
     state = MonsterState::Asleep;
 
@@ -321,7 +289,7 @@ Dude::Dude(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &
     currentFrame = std::get<0>(stateFrames[state]);
 }
 
-Harry::Harry(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
+Harry::Harry(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
     health = 30;
     state = MonsterState::Asleep;
 
@@ -342,7 +310,7 @@ Harry::Harry(const Segment *segment, const std::vector<raylib::TextureUnmanaged>
     currentFrame = std::get<0>(stateFrames[state]);
 }
 
-Kid::Kid(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 1, 50.f, 20.0f, 200.0f) {
+Kid::Kid(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 1, 50.f, 20.0f, 200.0f) {
     health = 5;
     state = MonsterState::Asleep;
 
@@ -363,7 +331,7 @@ Kid::Kid(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &te
     currentFrame = std::get<0>(stateFrames[state]);
 }
 
-Nurse::Nurse(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Nurse, 3, 50.f, 20.0f, 200.0f) {
+Nurse::Nurse(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Nurse, 3, 50.f, 20.0f, 200.0f) {
     health = 30;
     state = MonsterState::Standing;
 
@@ -379,7 +347,7 @@ Nurse::Nurse(const Segment *segment, const std::vector<raylib::TextureUnmanaged>
     currentFrame = std::get<0>(stateFrames[state]);
 }
 
-Roy::Roy(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
+Roy::Roy(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
     health = 30;
     state = MonsterState::Asleep;
 
@@ -400,7 +368,7 @@ Roy::Roy(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &te
     currentFrame = std::get<0>(stateFrames[state]);
 }
 
-Tor::Tor(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
+Tor::Tor(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
     health = 30;
     state = MonsterState::Asleep;
 
@@ -421,7 +389,7 @@ Tor::Tor(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &te
     currentFrame = std::get<0>(stateFrames[state]);
 }
 
-Wolf::Wolf(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
+Wolf::Wolf(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 2, 50.f, 20.0f, 200.0f) {
     health = 5;
     state = MonsterState::Asleep;
 
@@ -470,7 +438,7 @@ Collision Wolf::collide() const {
     return Collision::Block;
 }
 
-Drummer::Drummer(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 0, 50.f, 20.0f, 200.0f) {
+Drummer::Drummer(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 75.0f, DeathType::Zombie, 0, 50.f, 20.0f, 200.0f) {
     health = 1;
     state = MonsterState::Standing;
 
@@ -507,7 +475,7 @@ void Drummer::onDeath(Player *player) {
     world->getMusicPlayer()->stop();
 }
 
-Tank::Tank(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures) : Base(segment, textures, 0.0f, DeathType::Zombie, 0, 50.f, 20.0f, 200.0f) {
+Tank::Tank(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 0.0f, DeathType::Zombie, 0, 50.f, 20.0f, 200.0f) {
     health = 20;
     state = MonsterState::Standing;
 
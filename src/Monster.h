@@ -54,7 +54,7 @@ protected:
     uint64_t currentFrame = 0;
     raylib::Vector2 position;
     float radius;
-    const std::vector<raylib::TextureUnmanaged> &textures;
+    const std::vector<CelHandle> &textures;
     MonsterState state;
     std::unordered_map<MonsterState, std::tuple<size_t, size_t, MonsterState>> stateFrames;
     std::unordered_map<MonsterSound, raylib::Sound*> sounds;
@@ -70,10 +70,10 @@ protected:
     virtual void onDeath(Player *player) {
     }
 public:
-    Base(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures, const float step_size, const DeathType death_type, const int attack_damage, float notice_distance, float attack_distance, float walk_distance);
+    Base(const Segment *segment, const std::vector<CelHandle> &textures, const float step_size, const DeathType death_type, const int attack_damage, float notice_distance, float attack_distance, float walk_distance);
 
     void damage(Player *player, const DamageType damage_type, int amount);
-    std::optional<raylib::RayCollision> collide(const raylib::Ray &ray);
+    std::optional<HitShape> getHitShape() const;
 
     std::optional<std::pair<raylib::Vector2, float>> getBounds() const;
     std::optional<raylib::Vector2> getPosition() const;
@@ -91,57 +91,57 @@ public:
 
 class Bat : public Base {
 public:
-    Bat(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Bat(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 class CJ : public Base {
 public:
-    CJ(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    CJ(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 class Doc : public Base {
     bool taken = false;
     void onDeath(Player *player);
 public:
-    Doc(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Doc(const Segment *segment, const std::vector<CelHandle> &textures);
     void touch(Player *player);
     Collision collide() const;
 };
 
 class Dude : public Base {
 public:
-    Dude(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Dude(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 class Harry : public Base {
 public:
-    Harry(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Harry(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 class Kid : public Base {
 public:
-    Kid(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Kid(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 class Nurse : public Base {
 public:
-    Nurse(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Nurse(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 class Roy : public Base {
 public:
-    Roy(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Roy(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 class Tor : public Base {
 public:
-    Tor(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Tor(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 class Wolf : public Base {
     bool taken = false;
 public:
-    Wolf(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Wolf(const Segment *segment, const std::vector<CelHandle> &textures);
     void touch(Player *player);
     Collision collide() const;
 };
@@ -149,14 +149,14 @@ public:
 class Drummer : public Base {
     void onDeath(Player *player);
 public:
-    Drummer(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Drummer(const Segment *segment, const std::vector<CelHandle> &textures);
     void update(Player *player, uint64_t frame_count);
 };
 
 class Tank : public Base {
     void onDeath(Player *player);
 public:
-    Tank(const Segment *segment, const std::vector<raylib::TextureUnmanaged> &textures);
+    Tank(const Segment *segment, const std::vector<CelHandle> &textures);
 };
 
 };
@@ -20,7 +20,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Fnt.h"
 #include "StillCel.h"
 
-Panel::Panel() {
+Panel::Panel() : layer(raylib::Rectangle(0, 138, 320, 62)) {
     background = StillCel("stillcel/border.cel").getTexture();
 
     buttons.emplace(Action::Look, Button(raylib::Vector2(39, 147), StillCel("stillcel/b_aicon0.cel").getTexture()));
@@ -38,20 +38,26 @@ Panel::Panel() {
     movements.emplace(Input::StepRight, Button(raylib::Vector2(255, 162), StillCel("stillcel/b_arrow5.cel").getTexture()));
 }
 
-void Panel::draw(Player *player, const std::pair<std::string, std::optional<raylib::Color>> &higlight, int scale) {
-    background.Draw(Vector2(0, 138*scale), 0.0f, scale);
+void Panel::update(Player *player, int scale) {
+    layer.update(player->getUiRevision(), scale, [this, player, scale]() {
+        background.Draw(Vector2(0, 138*scale), 0.0f, scale);
 
-    auto [message, colour] = higlight;
+        auto [message, colour] = player->getHighlight();
 
-    Fnt::Write(message, 12*scale, 183*scale, scale, colour);
+        Fnt::Write(message, 12*scale, 183*scale, scale, colour);
 
-    auto health_text = std::to_string(player->getHealth());
-    auto ammo1_text = std::to_string(player->getItemCount(Item::Ammo1));
-    auto ammo2_text = std::to_string(player->getItemCount(Item::Ammo2));
+        auto health_text = std::to_string(player->getHealth());
+        auto ammo1_text = std::to_string(player->getItemCount(Item::Ammo1));
+        auto ammo2_text = std::to_string(player->getItemCount(Item::Ammo2));
 
-    Fnt::Write(health_text, 170*scale, 145*scale, scale);
-    Fnt::Write(ammo1_text, 170*scale, 157*scale, scale);
-    Fnt::Write(ammo2_text, 170*scale, 169*scale, scale);
+        Fnt::Write(health_text, 170*scale, 145*scale, scale);
+        Fnt::Write(ammo1_text, 170*scale, 157*scale, scale);
+        Fnt::Write(ammo2_text, 170*scale, 169*scale, scale);
+    });
+}
+
+void Panel::draw(Player *player, int scale) {
+    layer.draw();
 
     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
         //player->setAction(std::nullopt);
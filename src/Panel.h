@@ -30,6 +30,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "Player.h"
 #include "Fnt.h"
+#include "UiLayer.h"
 
 class Panel {
     struct Button {
@@ -50,10 +51,16 @@ class Panel {
 
     raylib::TextureUnmanaged background;
 
+    // border, message line and counters
+    UiLayer layer;
+
     State previous;
 public: 
     Panel();
-    void draw(Player *player, const std::pair<std::string, std::optional<raylib::Color>> &higlight, int scale);
+
+    // call before Screen::BeginFrame
+    void update(Player *player, int scale);
+    void draw(Player *player, int scale);
     ~Panel();
 };
 
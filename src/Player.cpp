@@ -21,6 +21,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "StillCel.h"
 #include "SoundCache.h"
 
+#include <algorithm>
 #include <iostream>
 
 #ifndef M_PI
@@ -35,6 +36,10 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #define RAD2DEG (180.0f/M_PI)
 #endif
 
+// damage of a shot with every pellet on target and the cone the pellets spread over in degrees
+static const int shotgun_damage = 25;
+static const float shotgun_spread = 4.0f;
+
 Player::Player(World *world) : world(world), angles(0, 0), state(State::World), deathType(DeathType::None) {
     camera = raylib::Camera(
         raylib::Vector3(0, 6.0f, 0),
@@ -69,25 +74,14 @@ Player::Player(World *world) : world(world), angles(0, 0), state(State::World),
 
         World *world = player->getWorld();
         Level *level = world->getCurrentLevel();
-        Map *map = level->getMap();
 
         sound->Play();
 
-        for (const auto &segment : map->getSegments()) {
-            Entity *entity = world->getEntity(segment.id);
-
-            if (entity) {
-                auto if_collision = entity->collide(ray);
-
-                if (if_collision) {
-                    auto collision = *if_collision;
+        // only the nearest thing along the ray takes the shot
+        auto hits = level->castRay(ray, 1000);
 
-                    if (collision.GetDistance() < 1000) {
-                        entity->damage(player, DamageType::Bullet, 20);
-                    }
-                }
-            }
-        }
+        if (!hits.empty())
+            hits.front().entity->damage(player, DamageType::Bullet, 20);
     }, Item::Ammo1);
 
     weapons[Item::Shotgun] = Weapon(40, {
@@ -107,26 +101,39 @@ Player::Player(World *world) : world(world), angles(0, 0), state(State::World),
 
         World *world = player->getWorld();
         Level *level = world->getCurrentLevel();
-        Map *map = level->getMap();
 
         sound->Play();
 
-        for (const auto &segment : map->getSegments()) {
-            Entity *entity = world->getEntity(segment.id);
+        RayPacket packet(ray, player->weapons.at(Item::Shotgun).pellets, shotgun_spread);
+        const int pellets = packet.getCount();
+        auto hits = level->castPacket(packet, 1000);
 
-            if (entity) {
-                auto if_collision = entity->collide(ray);
+        // pellets landing on the same thing add up into one hit, a monster ignores any further damage while it is hurt
+        std::vector<std::pair<Entity *, int>> damage;
 
-                if (if_collision) {
-                    auto collision = *if_collision;
+        for (int pellet = 0; pellet < pellets; pellet++) {
+            const auto &hit = hits[pellet];
 
-                    if (collision.GetDistance() < 1000) {
-                        entity->damage(player, DamageType::Bullet, 25);
-                    }
-                }
-            }
+            if (!hit)
+                continue;
+
+            // each pellet's share of the damage, a full hit adds up to exactly shotgun_damage
+            const int amount = shotgun_damage * (pellet + 1) / pellets - shotgun_damage * pellet / pellets;
+
+            auto target = std::find_if(std::begin(damage), std::end(damage), [&hit](const auto &target) {
+                return target.first == hit->entity;
+            });
+
+            if (target == std::end(damage))
+                damage.push_back(std::make_pair(hit->entity, amount));
+            else
+                target->second += amount;
+        }
+
+        for (const auto &[entity, amount] : damage) {
+            entity->damage(player, DamageType::Bullet, amount);
         }
-    }, Item::Ammo2);
+    }, Item::Ammo2, 12);
 
     weapons[Item::Uzi] = Weapon(10, {
         StillCel("stillcel/uzi1.cel").getTexture(),
@@ -145,25 +152,13 @@ Player::Player(World *world) : world(world), angles(0, 0), state(State::World),
 
         World *world = player->getWorld();
         Level *level = world->getCurrentLevel();
-        Map *map = level->getMap();
 
         sound->Play();
 
-        for (const auto &segment : map->getSegments()) {
-            Entity *entity = world->getEntity(segment.id);
-
-            if (entity) {
-                auto if_collision = entity->collide(ray);
-
-                if (if_collision) {
-                    auto collision = *if_collision;
+        auto hits = level->castRay(ray, 1000);
 
-                    if (collision.GetDistance() < 1000) {
-                        entity->damage(player, DamageType::Bullet, 15);
-                    }
-                }
-            }
-        }
+        if (!hits.empty())
+            hits.front().entity->damage(player, DamageType::Bullet, 15);
     }, Item::Ammo3);
 
     weapons[Item::Machete] = Weapon(40, {
@@ -178,26 +173,13 @@ Player::Player(World *world) : world(world), angles(0, 0), state(State::World),
 
         World *world = player->getWorld();
         Level *level = world->getCurrentLevel();
-        Map *map = level->getMap();
 
         sound->Play();
 
-        for (const auto &segment : map->getSegments()) {
-            Entity *entity = world->getEntity(segment.id);
-
-            if (entity) {
-                auto if_collision = entity->collide(ray);
-
-                if (if_collision) {
-                    auto collision = *if_collision;
+        auto hits = level->castRay(ray, 15);
 
-                    if (collision.GetDistance() < 15) {
-                        entity->damage(player, DamageType::Machete, 10);
-                        break;
-                    }
-                }
-            }
-        }
+        if (!hits.empty())
+            hits.front().entity->damage(player, DamageType::Machete, 10);
     });
 
     respawn(raylib::Vector2(), true);
@@ -208,6 +190,8 @@ bool Player::takeStep(const Map &map) {
 }
 
 void Player::addItem(Item item, int count) {
+    uiRevision++;
+
     if (items.contains(item)) {
         items[item] += count;
     } else {
@@ -232,6 +216,8 @@ int Player::getItemCount(const Item item) const {
 }
 
 std::pair<bool, std::string> Player::useItemOnItem(Item source, Item destination) {
+    uiRevision++;
+
     if (source == Item::OilCan && destination == Item::Rags) {
         items[Item::Rags] = 0;
         items[Item::OilyRags] = -1;
@@ -344,6 +330,7 @@ void Player::useWeapon(uint64_t frame_count) {
             }
 
             weapon_object.use(this);
+            uiRevision++;
             weaponStartFrame = frame_count;
             weaponEndFrame = frame_count + weapon_object.attackFrameCount;
         }
@@ -355,29 +342,18 @@ void Player::useWeapon(uint64_t frame_count) {
 
 void Player::use(uint64_t frame_count) {
     Level *level = world->getCurrentLevel();
-    Map *map = level->getMap();
 
     auto ray = camera.GetScreenToWorldRay(raylib::Vector2(160, 100), 320, 200);
 
-    for (const auto &segment : map->getSegments()) {
-        Entity *entity = world->getEntity(segment.id);
+    auto hits = level->castRay(ray, 20);
 
-        if (entity) {
-            auto if_collision = entity->collide(ray);
-
-            if (if_collision) {
-                auto collision = *if_collision;
-
-                if (collision.GetDistance() < 20) {
-                    entity->use(this, selected);
-                    break;
-                }
-            }
-        }
-    }
+    if (!hits.empty())
+        hits.front().entity->use(this, selected);
 }
 
 void Player::useItem(const Item item) {
+    uiRevision++;
+
     switch (item) {
         case Item::Coconut:
             if (getItemCount(item) > 0) {
@@ -534,7 +510,6 @@ std::pair<raylib::Vector3, raylib::Vector3> Player::processInput(const uint64_t
 void Player::tryMove(const raylib::Vector3 &movement, const raylib::Vector3 &rotation) {
     auto *world = getWorld();
     auto *level = world->getCurrentLevel();
-    auto *map = level->getMap();
 
     auto camera_position = camera.GetPosition();
 
@@ -563,104 +538,13 @@ void Player::tryMove(const raylib::Vector3 &movement, const raylib::Vector3 &rot
 
         bool reset = false;
 
-        for (const auto &segment : map->getSegments()) {
-            Entity *entity = world->getEntity(segment.id);
-            if (entity) {
-                auto bounds_if = entity->getBounds();
-                if (bounds_if) {
-                    auto bounds = *bounds_if;
-
-                    float distance = bounds.first.Distance(new_position);
-                    if (bounds.second + radius > distance) {
-                        auto collision = entity->collide();
-
-                        if (collision == Collision::Block) {
-                            reset = true;
-                        } else if (collision == Collision::Touch) {
-                            entity->touch(this);
-                            reset = true;
-                        }
-                    }
-
-                    continue;
-                }
-
-                // horizontal segments
-                if (segment.y1 == segment.y2) {
-                    uint16_t x1 = segment.x1;
-                    uint16_t x2 = segment.x2;
-                    uint16_t y1 = segment.y1;
-
-                    if (x1 > x2) {
-                        std::swap(x1, x2);
-                    }
-
-                    if (new_position.x >= x1 && new_position.x <= x2) {
-                        int north = new_position.y - radius;
-                        int south = new_position.y + radius;
-
-                        if (y1 < new_position.y && y1 > north) {
-                            auto collision = entity->collide();
-                            if (collision == Collision::Block) {
-                                reset = true;
-                            } else if (collision == Collision::Touch) {
-                                reset = true;
-                                entity->touch(this);
-                            }
-
-                            break;
-                        }
-
-                        if (y1 > new_position.y && y1 < south) {
-                            auto collision = entity->collide();
-                            if (collision == Collision::Block) {
-                                reset = true;
-                            } else if (collision == Collision::Touch) {
-                                reset = true;
-                                entity->touch(this);
-                            }
-                            break;
-                        }
-                    }
-                }
-
-                // vertical segments
-                if (segment.x1 == segment.x2) {
-                    uint16_t y1 = segment.y1;
-                    uint16_t y2 = segment.y2;
-                    uint16_t x1 = segment.x1;
-
-                    if (y1 > y2) {
-                        std::swap(y1, y2);
-                    }
-
-                    if (new_position.y >= y1 && new_position.y <= y2) {
-                        int west = new_position.x - radius;
-                        int east = new_position.x + radius;
-
-                        if (x1 < new_position.x && x1 > west) {
-                            auto collision = entity->collide();
-                            if (collision == Collision::Block) {
-                                reset = true;
-                            } else if (collision == Collision::Touch) {
-                                reset = true;
-                                entity->touch(this);
-                            }
-                            break;
-                        }
-
-                        if (x1 > new_position.x && x1 < east) {
-                            auto collision = entity->collide();
-                            if (collision == Collision::Block) {
-                                reset = true;
-                            } else if (collision == Collision::Touch) {
-                                reset = true;
-                                entity->touch(this);
-                            }
-                            break;
-                        }
-                    }
-                }
+        // only what shares a grid cell with the player can be within reach
+        for (const auto &[entity, collision] : level->getSpatialIndex()->collide(new_position, radius)) {
+            if (collision == Collision::Block) {
+                reset = true;
+            } else if (collision == Collision::Touch) {
+                entity->touch(this);
+                reset = true;
             }
         }
 
@@ -679,6 +563,8 @@ void Player::update(const uint64_t frame_count) {
 }
 
 void Player::takeDamage(const int amount, const DeathType death_type) {
+    uiRevision++;
+
     health -= amount;
 
     health = std::max(health, 0);
@@ -689,6 +575,8 @@ void Player::takeDamage(const int amount, const DeathType death_type) {
 }
 
 void Player::respawn(const raylib::Vector2 &new_position, const bool reset_inventory) {
+    uiRevision++;
+
     if (reset_inventory) {
         items[Item::Rifle] = 0;
         items[Item::Uzi] = 0;
@@ -39,6 +39,8 @@ class Player {
         std::vector<raylib::TextureUnmanaged> frames;
         std::function<void(Player *player)> use;
         std::optional<Item> ammo = std::nullopt;
+        // rays fired per use, their damage is shared out between them
+        int pellets = 1;
     };
 
     World *world;
@@ -67,6 +69,9 @@ class Player {
     std::string highlight = "";
     std::optional<raylib::Color> highlightColour = std::nullopt;
 
+    // bumped whenever something the panel or inventory shows changes
+    uint32_t uiRevision = 0;
+
     std::pair<raylib::Vector3, raylib::Vector3> processInput(const uint64_t frame_count);
     void tryMove(const raylib::Vector3 &movement, const raylib::Vector3 &rotation);
 
@@ -137,6 +142,7 @@ public:
 
     void setSelectedItem(std::optional<Item> new_selected) {
         selected = new_selected;
+        uiRevision++;
     }
 
     std::optional<Action> getAction() const {
@@ -175,6 +181,11 @@ public:
     void setHighlight(const std::string &new_highlight="", std::optional<raylib::Color> highlight_colour=std::nullopt) {
         highlight = new_highlight;
         highlightColour = highlight_colour;
+        uiRevision++;
+    }
+
+    uint32_t getUiRevision() const {
+        return uiRevision;
     }
 
     void takeDamage(const int amount, const DeathType death_type);
@@ -0,0 +1,172 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "RayPacket.h"
+
+RayPacket::RayPacket(const raylib::Ray &ray, int count, float spread) : centre(ray), count(std::clamp(count, 1, MaxRays)) {
+    raylib::Vector3 forward = raylib::Vector3(ray.direction).Normalize();
+    raylib::Vector3 right = forward.CrossProduct(raylib::Vector3(0.0f, 1.0f, 0.0f));
+
+    // straight up or down there is no horizon to fan out along
+    if (right.Length() < 1e-4f)
+        right = raylib::Vector3(1.0f, 0.0f, 0.0f);
+
+    right = right.Normalize();
+    raylib::Vector3 up = right.CrossProduct(forward);
+
+    centre.direction = forward;
+
+    // lanes past count stay zero length and never hit
+    x.fill(0.0f);
+    y.fill(0.0f);
+    z.fill(0.0f);
+
+    const float golden_angle = 2.39996323f;
+    const float radius = std::tan(spread * DEG2RAD);
+
+    for (int ray = 0; ray < this->count; ray++) {
+        // the first ray is the centre one, the last sits on the edge of the cone
+        float offset = this->count > 1 ? radius * std::sqrt((float)ray / (this->count - 1)) : 0.0f;
+        float angle = ray * golden_angle;
+
+        raylib::Vector3 direction = (forward + right * (std::cos(angle) * offset) + up * (std::sin(angle) * offset)).Normalize();
+
+        x[ray] = direction.x;
+        y[ray] = direction.y;
+        z[ray] = direction.z;
+    }
+}
+
+float RayPacket::getHorizontalSpread() const {
+    float spread = 0.0f;
+
+    for (int ray = 0; ray < count; ray++) {
+        spread = std::max(spread, raylib::Vector2(x[ray] - centre.direction.x, z[ray] - centre.direction.z).Length());
+    }
+
+    return spread;
+}
+
+void RayPacket::intersect(const HitShape &shape, float *distances) const {
+    if (shape.type == HitShape::Type::Sphere)
+        intersectSphere(shape, distances);
+    else
+        intersectQuad(shape, distances);
+}
+
+void RayPacket::intersectQuad(const HitShape &shape, float *distances) const {
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // the quad stands in the plane x = start.x when it runs along z, else in z = start.z
+    const bool along_z = shape.start.x == shape.end.x;
+
+    const float *axis = along_z ? x.data() : z.data();
+    const float *other = along_z ? z.data() : x.data();
+
+    const float plane = along_z ? shape.start.x - centre.position.x : shape.start.z - centre.position.z;
+    const float origin = along_z ? centre.position.z : centre.position.x;
+    const float low = along_z ? std::min(shape.start.z, shape.end.z) : std::min(shape.start.x, shape.end.x);
+    const float high = along_z ? std::max(shape.start.z, shape.end.z) : std::max(shape.start.x, shape.end.x);
+
+    int ray = 0;
+
+#if defined(__SSE2__)
+    const __m128 plane4 = _mm_set1_ps(plane);
+    const __m128 origin4 = _mm_set1_ps(origin);
+    const __m128 height4 = _mm_set1_ps(centre.position.y);
+    const __m128 low4 = _mm_set1_ps(low);
+    const __m128 high4 = _mm_set1_ps(high);
+    const __m128 top4 = _mm_set1_ps(shape.size);
+    const __m128 infinity4 = _mm_set1_ps(infinity);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; ray + 4 <= count; ray += 4) {
+        // rays parallel to the plane divide by zero, the infinities and NaNs fail every compare below
+        __m128 t = _mm_div_ps(plane4, _mm_load_ps(axis + ray));
+        __m128 across = _mm_add_ps(origin4, _mm_mul_ps(t, _mm_load_ps(other + ray)));
+        __m128 up = _mm_add_ps(height4, _mm_mul_ps(t, _mm_load_ps(y.data() + ray)));
+
+        __m128 hit = _mm_cmpgt_ps(t, zero);
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(across, low4), _mm_cmple_ps(across, high4)));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(up, zero), _mm_cmple_ps(up, top4)));
+
+        _mm_storeu_ps(distances + ray, _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, infinity4)));
+    }
+#endif
+
+    for (; ray < count; ray++) {
+        float t = plane / axis[ray];
+        float across = origin + t * other[ray];
+        float up = centre.position.y + t * y[ray];
+
+        bool hit = t > 0.0f && across >= low && across <= high && up >= 0.0f && up <= shape.size;
+        distances[ray] = hit ? t : infinity;
+    }
+}
+
+void RayPacket::intersectSphere(const HitShape &shape, float *distances) const {
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // every ray starts at the same origin, so only the projection onto each ray differs
+    const raylib::Vector3 offset = raylib::Vector3(shape.start) - centre.position;
+    const float outside = offset.DotProduct(offset) - shape.size * shape.size;
+
+    // from inside the sphere the ray hits on the way out, like GetRayCollisionSphere
+    const float sign = outside < 0.0f ? 1.0f : -1.0f;
+
+    int ray = 0;
+
+#if defined(__SSE2__)
+    const __m128 offset_x = _mm_set1_ps(offset.x);
+    const __m128 offset_y = _mm_set1_ps(offset.y);
+    const __m128 offset_z = _mm_set1_ps(offset.z);
+    const __m128 outside4 = _mm_set1_ps(outside);
+    const __m128 sign4 = _mm_set1_ps(sign);
+    const __m128 infinity4 = _mm_set1_ps(infinity);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; ray + 4 <= count; ray += 4) {
+        __m128 along = _mm_mul_ps(offset_x, _mm_load_ps(x.data() + ray));
+        along = _mm_add_ps(along, _mm_mul_ps(offset_y, _mm_load_ps(y.data() + ray)));
+        along = _mm_add_ps(along, _mm_mul_ps(offset_z, _mm_load_ps(z.data() + ray)));
+
+        __m128 discriminant = _mm_sub_ps(_mm_mul_ps(along, along), outside4);
+        __m128 t = _mm_add_ps(along, _mm_mul_ps(sign4, _mm_sqrt_ps(_mm_max_ps(discriminant, zero))));
+
+        __m128 hit = _mm_and_ps(_mm_cmpge_ps(discriminant, zero), _mm_cmpgt_ps(t, zero));
+
+        _mm_storeu_ps(distances + ray, _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, infinity4)));
+    }
+#endif
+
+    for (; ray < count; ray++) {
+        float along = offset.x * x[ray] + offset.y * y[ray] + offset.z * z[ray];
+        float discriminant = along * along - outside;
+        float t = along + sign * std::sqrt(std::max(discriminant, 0.0f));
+
+        distances[ray] = discriminant >= 0.0f && t > 0.0f ? t : infinity;
+    }
+}
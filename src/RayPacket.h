@@ -0,0 +1,66 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+
+#include <array>
+#include <cstdint>
+
+#include <raylib-cpp.hpp>
+
+#include "Entity.h"
+
+// Rays from one origin fanned out around a centre ray, stored a component per array so four are tested at once
+class RayPacket {
+public:
+    static const int MaxRays = 16;
+private:
+    raylib::Ray centre;
+    int count;
+
+    alignas(16) std::array<float, MaxRays> x;
+    alignas(16) std::array<float, MaxRays> y;
+    alignas(16) std::array<float, MaxRays> z;
+
+    void intersectQuad(const HitShape &shape, float *distances) const;
+    void intersectSphere(const HitShape &shape, float *distances) const;
+public:
+    // count rays spread over a cone of spread degrees on a golden angle spiral, so the pattern is even and repeatable
+    RayPacket(const raylib::Ray &ray, int count, float spread);
+
+    int getCount() const {
+        return count;
+    }
+
+    const raylib::Ray &getCentre() const {
+        return centre;
+    }
+
+    raylib::Ray getRay(int ray) const {
+        return raylib::Ray(centre.position, raylib::Vector3(x[ray], y[ray], z[ray]));
+    }
+
+    // furthest the horizontal part of any ray strays from the centre ray's per unit along it
+    float getHorizontalSpread() const;
+
+    // distance along each ray to the shape or infinity, same rules as HitShape::collide
+    void intersect(const HitShape &shape, float *distances) const;
+};
+
+#endif //RAYPACKET_H
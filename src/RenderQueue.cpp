@@ -0,0 +1,302 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <optional>
+#include <string>
+
+#include "RenderQueue.h"
+#include "BillboardRenderer.h"
+#include "SoftwareRenderer.h"
+
+static const char *vertex_shader = R"(
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out vec3 fragPosition;
+
+void main()
+{
+    // walls are submitted and baked in world space, so the position is already the world position
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+    fragPosition = vertexPosition;
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+})";
+
+static const char *animated_vertex_shader = R"(
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec2 vertexTexCoord2;
+in vec3 vertexNormal;
+in vec4 vertexColor;
+
+// Input uniform values
+uniform mat4 mvp;
+uniform int frameCounter;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out vec3 fragPosition;
+
+void main()
+{
+    // texcoord2 is frame count and rate, frames follow the first one in 64x64 slots of a 2048x2048 page
+    int frames = int(vertexTexCoord2.x);
+    int rate = int(vertexTexCoord2.y);
+    int frame = (frameCounter / rate) % frames;
+
+    // normal x marks a one shot animation and y is the frame it started on, -1 holds it on the first frame
+    if (vertexNormal.x > 0.5)
+        frame = vertexNormal.y < 0.0 ? 0 : clamp((frameCounter - int(vertexNormal.y)) / rate, 0, frames - 1);
+
+    ivec2 cel = ivec2(floor(vertexTexCoord*32.0));
+    int slot = cel.y*32 + cel.x + frame;
+
+    fragTexCoord = vertexTexCoord + vec2(ivec2(slot % 32, slot / 32) - cel)/32.0;
+    fragColor = vertexColor;
+    fragPosition = vertexPosition;
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+})";
+
+// shared by every wall and billboard, ALPHA_TEST is defined for everything but opaque walls
+static const char *fragment_shader = R"(
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+in vec3 fragPosition;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+uniform vec3 viewPosition;
+uniform vec4 fogColour;
+uniform float fogStart;
+uniform float fogEnd;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    vec4 texelColor = texture(texture0, fragTexCoord);
+#ifdef ALPHA_TEST
+    // mip levels keep coverage in alpha, whatever survives the cut is drawn solid
+    if (texelColor.a < 0.5) discard;
+    texelColor.a = 1.0;
+#endif
+    finalColor = texelColor * fragColor * colDiffuse;
+
+    // linear fog, fully fogged at fogEnd where Level culls, off when fogEnd is 0
+    if (fogEnd > 0.0) {
+        float fog = clamp((distance(fragPosition, viewPosition) - fogStart) / max(fogEnd - fogStart, 1.0), 0.0, 1.0);
+        finalColor.rgb = mix(finalColor.rgb, fogColour.rgb, fog);
+    }
+})";
+
+static std::string fragment_source(bool alpha_tested) {
+    return std::string("#version 330\n") + (alpha_tested ? "#define ALPHA_TEST\n" : "") + fragment_shader;
+}
+
+static const float wall_height = 12.0f;
+
+static std::vector<RenderQueue::Item> items;
+static RenderQueue::Stats stats = {0, 0, 0, 0};
+static SoftwareRenderer *software_target = nullptr;
+static uint64_t frame_counter = 0;
+static RenderQueue::Fog fog = {BLANK, 0.0f, 0.0f};
+
+static BillboardRenderer &billboards() {
+    // created on first use, after the window has a GL context
+    static BillboardRenderer renderer(fragment_source(true).c_str());
+    return renderer;
+}
+
+static void set_fog_uniforms(const Shader &shader, const raylib::Vector3 &view_position) {
+    const raylib::Vector4 colour = ColorNormalize(fog.colour);
+
+    SetShaderValue(shader, GetShaderLocation(shader, "viewPosition"), &view_position, SHADER_UNIFORM_VEC3);
+    SetShaderValue(shader, GetShaderLocation(shader, "fogColour"), &colour, SHADER_UNIFORM_VEC4);
+    SetShaderValue(shader, GetShaderLocation(shader, "fogStart"), &fog.start, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, GetShaderLocation(shader, "fogEnd"), &fog.end, SHADER_UNIFORM_FLOAT);
+}
+
+const raylib::ShaderUnmanaged &RenderQueue::GetOpaqueShader() {
+    // no discard, so the depth test can still run before shading
+    static raylib::ShaderUnmanaged shader = raylib::ShaderUnmanaged::LoadFromMemory(vertex_shader, fragment_source(false));
+    return shader;
+}
+
+const raylib::ShaderUnmanaged &RenderQueue::GetAlphaTestShader() {
+    static raylib::ShaderUnmanaged shader = raylib::ShaderUnmanaged::LoadFromMemory(vertex_shader, fragment_source(true));
+    return shader;
+}
+
+const raylib::ShaderUnmanaged &RenderQueue::GetAnimatedWallShader(bool alpha_tested) {
+    static raylib::ShaderUnmanaged opaque = raylib::ShaderUnmanaged::LoadFromMemory(animated_vertex_shader, fragment_source(false));
+    static raylib::ShaderUnmanaged alpha = raylib::ShaderUnmanaged::LoadFromMemory(animated_vertex_shader, fragment_source(true));
+
+    return alpha_tested ? alpha : opaque;
+}
+
+void RenderQueue::SetFog(const Fog &new_fog, const raylib::Vector3 &view_position) {
+    fog = new_fog;
+
+    set_fog_uniforms(GetOpaqueShader(), view_position);
+    set_fog_uniforms(GetAlphaTestShader(), view_position);
+    set_fog_uniforms(GetAnimatedWallShader(false), view_position);
+    set_fog_uniforms(GetAnimatedWallShader(true), view_position);
+    set_fog_uniforms(billboards().getShader(), view_position);
+}
+
+const RenderQueue::Fog &RenderQueue::GetFog() {
+    return fog;
+}
+
+void RenderQueue::SubmitWall(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, const CelHandle &texture) {
+    if (software_target) {
+        software_target->addWall(x1, y1, x2, y2, texture);
+        return;
+    }
+
+    if (y1 != y2)
+        x2 = x1;
+    else
+        y2 = y1;
+
+    items.push_back(Item(GetAlphaTestShader(), texture.atlas.id, std::array<raylib::Vector3, 4>{
+        raylib::Vector3(x1, 0, y1),
+        raylib::Vector3(x2, 0, y2),
+        raylib::Vector3(x2, wall_height, y2),
+        raylib::Vector3(x1, wall_height, y1),
+    }, texture.uv));
+}
+
+void RenderQueue::SubmitBillboard(const raylib::Vector3 &position, float size, const CelHandle &texture, const std::optional<CelAnimation> &animation) {
+    if (software_target) {
+        CelHandle frame = texture;
+
+        // the raycaster samples the CPU copy, so it steps the slot itself
+        if (animation)
+            frame.layer += animation->getFrame(frame_counter);
+
+        software_target->addSprite(position, size, frame);
+        return;
+    }
+
+    billboards().add(position, size, texture, animation.value_or(CelAnimation(1, 1)));
+}
+
+void RenderQueue::SetSoftwareTarget(SoftwareRenderer *renderer) {
+    software_target = renderer;
+}
+
+void RenderQueue::SetFrameCounter(uint64_t frame_count) {
+    frame_counter = frame_count;
+}
+
+void RenderQueue::Flush() {
+    // stable, so items sharing state keep their back to front order
+    std::stable_sort(std::begin(items), std::end(items), [](const Item &l, const Item &r) {
+        if (l.shader.id != r.shader.id)
+            return l.shader.id < r.shader.id;
+
+        return l.texture < r.texture;
+    });
+
+    stats.items = items.size();
+    stats.stateChanges = 0;
+
+    std::optional<unsigned int> current_shader;
+    std::optional<unsigned int> current_texture;
+
+    for (size_t i = 0; i < items.size();) {
+        const auto &state = items[i];
+
+        // one change per batch, whether the shader, the texture or both moved on
+        if (current_shader != state.shader.id || current_texture != state.texture)
+            stats.stateChanges++;
+
+        if (current_shader != state.shader.id) {
+            if (current_shader)
+                EndShaderMode();
+
+            BeginShaderMode(state.shader);
+            current_shader = state.shader.id;
+        }
+
+        current_texture = state.texture;
+
+        rlSetTexture(state.texture);
+        rlBegin(RL_QUADS);
+        {
+            rlColor4ub(0xFF, 0xFF, 0xFF, 0xFF);
+
+            for (; i < items.size() && items[i].shader.id == state.shader.id && items[i].texture == state.texture; i++) {
+                const auto &item = items[i];
+
+                const float u0 = item.uv.x;
+                const float u1 = item.uv.x + item.uv.width;
+                const float v0 = item.uv.y;
+                const float v1 = item.uv.y + item.uv.height;
+
+                const float texcoords[4][2] = {
+                    {u0, v1},
+                    {u1, v1},
+                    {u1, v0},
+                    {u0, v0},
+                };
+
+                for (int corner = 0; corner < 4; corner++) {
+                    rlTexCoord2f(texcoords[corner][0], texcoords[corner][1]);
+                    rlVertex3f(item.corners[corner].x, item.corners[corner].y, item.corners[corner].z);
+                }
+            }
+        }
+        rlEnd();
+        rlSetTexture(0);
+    }
+
+    if (current_shader)
+        EndShaderMode();
+
+    items.clear();
+
+    stats.billboards = billboards().getCount();
+    billboards().draw(frame_counter);
+    stats.instancedDraws = billboards().getDrawCalls();
+}
+
+const RenderQueue::Stats &RenderQueue::GetStats() {
+    return stats;
+}
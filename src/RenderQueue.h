@@ -0,0 +1,82 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <cstdint>
+#include <array>
+#include <optional>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+#include "CelAtlas.h"
+
+class SoftwareRenderer;
+
+// Collects textured quads and billboards during the transparent pass and draws them grouped by shader and texture
+class RenderQueue {
+public:
+    struct Item {
+        Shader shader;
+        unsigned int texture;
+        std::array<raylib::Vector3, 4> corners;
+        raylib::Rectangle uv;
+    };
+
+    // linear fog towards colour between start and end, end 0 turns it off
+    struct Fog {
+        raylib::Color colour;
+        float start;
+        float end;
+    };
+
+    struct Stats {
+        size_t items;
+        size_t stateChanges;
+        size_t billboards;
+        size_t instancedDraws;
+    };
+
+    static const raylib::ShaderUnmanaged &GetOpaqueShader();
+    static const raylib::ShaderUnmanaged &GetAlphaTestShader();
+    // for StaticGeometry meshes carrying frame count and rate in texcoords2
+    static const raylib::ShaderUnmanaged &GetAnimatedWallShader(bool alpha_tested);
+
+    static void SubmitWall(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, const CelHandle &texture);
+    // billboards skip the quad list and go to the instanced BillboardRenderer
+    static void SubmitBillboard(const raylib::Vector3 &position, float size, const CelHandle &texture, const std::optional<CelAnimation> &animation = std::nullopt);
+
+    static void Flush();
+
+    // while set, walls and billboards go to the software renderer instead of the GPU
+    static void SetSoftwareTarget(SoftwareRenderer *renderer);
+
+    // applies to every wall and billboard shader, set once a frame after the camera has moved
+    static void SetFog(const Fog &fog, const raylib::Vector3 &view_position);
+    static const Fog &GetFog();
+
+    // clock for animated billboards, set once a frame before anything is submitted
+    static void SetFrameCounter(uint64_t frame_count);
+
+    // counts from the last Flush
+    static const Stats &GetStats();
+};
+
+#endif //RENDERQUEUE_H
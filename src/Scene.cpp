@@ -23,11 +23,23 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Strings.h"
 #include "SoundCache.h"
 #include "TextureCache.h"
+#include "Screen.h"
 
-Scene::Scene(Panel *panel, const std::string &background_filename) : panel(panel) {
+Scene::Scene(Panel *panel, const std::string &background_filename) : panel(panel), layer(raylib::Rectangle(0, 0, 320, 138)) {
     background = TextureCache::LoadStillCel(background_filename);
 }
 
+bool Scene::isOverAnimation(const Layout &layout) const {
+    auto border = layout.Border();
+
+    for (const auto &[animation_id, animation] : animations) {
+        if (border.CheckCollision(animation.Border()))
+            return true;
+    }
+
+    return false;
+}
+
 std::tuple<bool, std::string, DeathType> Scene::useItemOnItem(Item source, Item destination) {
     const static std::string DIDNT_WORK = Strings::Lookup(326);
 
@@ -64,12 +76,22 @@ void Scene::draw(Player *player, int scale) {
         Input::LookDown,
     };
 
-    BeginDrawing();
+    layer.update(0, scale, [this, scale]() {
+        background.Draw(Vector2(0, 0), 0.0f, scale);
+
+        for (const auto &layout : layouts) {
+            if (!isOverAnimation(layout))
+                layout.draw(scale);
+        }
+    });
+    panel->update(player, scale);
+
+    Screen::BeginFrame();
     {
 
         uint64_t player_input = player->getInput();
 
-        background.Draw(Vector2(0, 0), 0.0f, scale);
+        layer.draw();
 
         for (auto it = animations.begin(); it != animations.end();) {
             auto &[animation_id, animation] = *it;
@@ -77,13 +99,15 @@ void Scene::draw(Player *player, int scale) {
             if (animation.draw(scale)) {
                 animationCompleted(player, animation_id);
                 animations.erase(it++);
+                layer.invalidate();
             } else {
                 ++it;
             }
         }
 
         for (const auto &layout : layouts) {
-            layout.draw(scale);
+            if (isOverAnimation(layout))
+                layout.draw(scale);
         }
 
         if (player_input) {
@@ -205,13 +229,15 @@ void Scene::draw(Player *player, int scale) {
                         player->setHighlight();
                 }
             }
+
+            layer.invalidate();
         }
 
         player->setInput(player_input);
 
-        panel->draw(player, player->getHighlight(), scale);
+        panel->draw(player, scale);
     }
-    EndDrawing(); 
+    Screen::EndFrame(); 
 }
 
 void Scene::animationCompleted(Player *player, uint16_t animation_id) {
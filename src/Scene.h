@@ -32,6 +32,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "Panel.h"
 #include "Entrance.h"
+#include "UiLayer.h"
 
 class Scene {
 protected:
@@ -64,6 +65,15 @@ protected:
             return false;
         }
 
+        raylib::Rectangle Border() const {
+            for (const auto &frame : frames) {
+                if (frame)
+                    return raylib::Rectangle(position.GetX(), position.GetY(), frame->GetWidth(), frame->GetHeight());
+            }
+
+            return raylib::Rectangle(position.GetX(), position.GetY(), 0, 0);
+        }
+
         Animation(const raylib::Vector2 &position, const std::vector<std::optional<raylib::TextureUnmanaged>> &frames, bool loop=true, size_t frame_rate=6) : position(position), frames(frames), loop(loop), frameRate(frame_rate), count(0) {}
         Animation(const Animation &other) : position(other.position), frames(other.frames), loop(other.loop), frameRate(other.frameRate), count(other.count) {}
         Animation() : loop(true), frameRate(6), count(0) {}
@@ -104,6 +114,12 @@ private:
 
     Panel *panel;
     raylib::TextureUnmanaged background;
+
+    // background and layouts, redrawn after anything that can add or remove a layout or animation
+    UiLayer layer;
+
+    // layouts over an animation are drawn each frame so they stay on top of it
+    bool isOverAnimation(const Layout &layout) const;
     Scene(Panel *panel, const std::string &background_filename);
 
     std::vector<Layout> layouts;
@@ -0,0 +1,193 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+
+#include "Screen.h"
+#include "Capture.h"
+#include "GLExtensions.h"
+
+static std::optional<RenderTexture2D> target;
+static double frame_start = 0.0;
+static float busy_time = 0.0f;
+
+// GPU timer queries in flight, read back a few frames late so nothing waits on the GPU
+static const size_t timer_queries = 4;
+static std::array<unsigned int, timer_queries> queries = {};
+static std::array<bool, timer_queries> pending = {};
+static size_t query_index = 0;
+static bool timing = false;
+static float gpu_time = 0.0f;
+
+static void begin_timer() {
+    // timer queries are GL 3.3, without them only the CPU side is measured
+    if (!glad_glGenQueries)
+        return;
+
+    if (!queries[0])
+        glad_glGenQueries(timer_queries, queries.data());
+
+    // oldest first, so the newest finished frame is the one kept
+    for (size_t i = 0; i < timer_queries; i++) {
+        size_t query = (query_index + i) % timer_queries;
+
+        if (!pending[query])
+            continue;
+
+        int available = 0;
+        glad_glGetQueryObjectiv(queries[query], gl_query_result_available, &available);
+
+        if (!available)
+            continue;
+
+        uint64_t nanoseconds = 0;
+        glad_glGetQueryObjectui64v(queries[query], gl_query_result, &nanoseconds);
+
+        gpu_time = nanoseconds / 1e9f;
+        pending[query] = false;
+    }
+
+    // the GPU is more than timer_queries frames behind, leave this frame untimed
+    if (pending[query_index])
+        return;
+
+    glad_glBeginQuery(gl_time_elapsed, queries[query_index]);
+    timing = true;
+}
+
+static void end_timer() {
+    if (!timing)
+        return;
+
+    glad_glEndQuery(gl_time_elapsed);
+
+    pending[query_index] = true;
+    query_index = (query_index + 1) % timer_queries;
+    timing = false;
+}
+
+static float frame_cost() {
+    // submitting barely depends on the resolution, so the frame costs whichever side is slower
+    return std::max((float)(GetTime() - frame_start), gpu_time);
+}
+
+// follows where the frame is drawn, the letterbox moves whenever the internal size steps
+static void map_mouse(const raylib::Rectangle &dest) {
+    static raylib::Rectangle mapped;
+
+    if (dest.x == mapped.x && dest.y == mapped.y && dest.width == mapped.width && dest.height == mapped.height)
+        return;
+
+    SetMouseOffset(-dest.x, -dest.y);
+    SetMouseScale(Screen::Width / dest.width, Screen::Height / dest.height);
+
+    mapped = dest;
+}
+
+// where the frame lands in the window, whole multiples keep the pixels square, only shrink below 1x if the window
+// is smaller
+static raylib::Rectangle frame_rect() {
+    if (!target)
+        return raylib::Rectangle(0.0f, 0.0f, GetScreenWidth(), GetScreenHeight());
+
+    float width = target->texture.width;
+    float height = target->texture.height;
+
+    float factor = std::min(GetScreenWidth() / width, GetScreenHeight() / height);
+    if (factor >= 1.0f)
+        factor = std::floor(factor);
+
+    return raylib::Rectangle((GetScreenWidth() - width * factor) / 2.0f, (GetScreenHeight() - height * factor) / 2.0f, width * factor, height * factor);
+}
+
+void Screen::SetInternalSize(int width, int height) {
+    if (target) {
+        if (target->texture.width == width && target->texture.height == height)
+            return;
+
+        UnloadRenderTexture(*target);
+        target = std::nullopt;
+    }
+
+    if (width && height) {
+        target = LoadRenderTexture(width, height);
+        SetTextureFilter(target->texture, TEXTURE_FILTER_POINT);
+    }
+
+    map_mouse(frame_rect());
+}
+
+int Screen::GetInternalWidth() {
+    return target ? target->texture.width : GetScreenWidth();
+}
+
+int Screen::GetInternalHeight() {
+    return target ? target->texture.height : GetScreenHeight();
+}
+
+float Screen::GetBusyTime() {
+    return busy_time;
+}
+
+void Screen::BeginFrame() {
+    frame_start = GetTime();
+    begin_timer();
+
+    if (target)
+        BeginTextureMode(*target);
+    else
+        BeginDrawing();
+}
+
+void Screen::EndFrame() {
+    if (!target) {
+        map_mouse(frame_rect());
+
+        rlDrawRenderBatchActive();
+        end_timer();
+
+        Capture::Update(GetRenderWidth(), GetRenderHeight());
+        busy_time = frame_cost();
+
+        EndDrawing();
+        return;
+    }
+
+    EndTextureMode();
+
+    raylib::Rectangle source(0.0f, 0.0f, target->texture.width, -target->texture.height);
+    raylib::Rectangle dest = frame_rect();
+
+    map_mouse(dest);
+
+    BeginDrawing();
+    {
+        ClearBackground(BLACK);
+        DrawTexturePro(target->texture, source, dest, Vector2(0.0f, 0.0f), 0.0f, WHITE);
+
+        rlDrawRenderBatchActive();
+        end_timer();
+
+        Capture::Update(GetRenderWidth(), GetRenderHeight());
+        busy_time = frame_cost();
+    }
+    EndDrawing();
+}
@@ -0,0 +1,47 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include <cstdint>
+
+#include <raylib-cpp.hpp>
+
+// Wraps BeginDrawing/EndDrawing so a frame can be drawn into a low resolution target and upscaled
+class Screen {
+public:
+    // the game's own resolution, mouse positions are reported in it wherever the frame lands in the window
+    static const int Width = 320;
+    static const int Height = 200;
+
+    // 0x0 draws straight to the window
+    static void SetInternalSize(int width, int height);
+
+    static int GetInternalWidth();
+    static int GetInternalHeight();
+
+    // seconds the last frame cost without the frame limiter wait, the larger of the CPU time from BeginFrame to
+    // presenting and the GPU time of a recent frame
+    static float GetBusyTime();
+
+    static void BeginFrame();
+    static void EndFrame();
+};
+
+#endif //SCREEN_H
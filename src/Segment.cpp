@@ -20,6 +20,22 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "Segment.h"
 
-Segment::Segment(size_t id, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t texture, uint16_t flags, uint16_t count) : id(id), x1(x1), y1(y1), x2(x2), y2(y2), texture(texture), flags(flags), count(count) {
+Segment::Segment(size_t id, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t texture, uint16_t flags, uint16_t count, uint32_t index) : id(id), x1(x1), y1(y1), x2(x2), y2(y2), texture(texture), flags(flags), count(count), index(index) {
 }
 
+void SegmentArrays::push_back(const Segment &segment) {
+    x1.push_back(segment.x1);
+    y1.push_back(segment.y1);
+    x2.push_back(segment.x2);
+    y2.push_back(segment.y2);
+
+    midX.push_back((segment.x1 + segment.x2) / 2.0f);
+    midY.push_back((segment.y1 + segment.y2) / 2.0f);
+
+    if (segment.y1 == segment.y2)
+        orientation.push_back(Orientation::Horizontal);
+    else if (segment.x1 == segment.x2)
+        orientation.push_back(Orientation::Vertical);
+    else
+        orientation.push_back(Orientation::Diagonal);
+}
@@ -24,6 +24,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <exception>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <raylib-cpp.hpp>
 
@@ -37,7 +38,35 @@ struct Segment {
     uint16_t flags;
     uint16_t count;
 
-    Segment(size_t id, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t texture, uint16_t flags, uint16_t count);
+    // position in the map file, indexes the per segment visibility bits
+    uint32_t index;
+
+    Segment(size_t id, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t texture, uint16_t flags, uint16_t count, uint32_t index);
+};
+
+// The same segments one field per array, lined up by index, for loops that only want coordinates
+struct SegmentArrays {
+    // a segment with y1 == y2 counts as horizontal even when it is a single point
+    enum class Orientation : uint8_t {
+        Horizontal,
+        Vertical,
+        Diagonal,
+    };
+
+    std::vector<float> x1;
+    std::vector<float> y1;
+    std::vector<float> x2;
+    std::vector<float> y2;
+
+    std::vector<float> midX;
+    std::vector<float> midY;
+    std::vector<Orientation> orientation;
+
+    void push_back(const Segment &segment);
+
+    size_t size() const {
+        return x1.size();
+    }
 };
 
 #endif //SEGMENT_H
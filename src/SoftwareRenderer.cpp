@@ -0,0 +1,417 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "SoftwareRenderer.h"
+#include "TextureCache.h"
+
+static const float wall_height = 12.0f;
+static const float near_depth = 0.1f;
+static const int cel_size = CelAtlas::CelSize;
+
+static raylib::TextureUnmanaged &frame_texture() {
+    // created on first use, after the window has a GL context, and shared by every level
+    static raylib::TextureUnmanaged texture = []() {
+        Image blank = GenImageColor(SoftwareRenderer::Width, SoftwareRenderer::Height, BLANK);
+        raylib::TextureUnmanaged texture(blank);
+        UnloadImage(blank);
+
+        return texture;
+    }();
+
+    return texture;
+}
+
+static uint32_t pack(const raylib::Color &colour) {
+    uint32_t packed;
+    std::memcpy(&packed, &colour, sizeof(packed));
+
+    return packed;
+}
+
+// scales one texel column over the screen rows from top to bottom, alpha tested columns skip texels with no alpha
+static void draw_column(uint32_t *column, const uint32_t *texels, float top, float bottom, bool alpha_test) {
+    static const uint32_t alpha_mask = pack(raylib::Color(0, 0, 0, 0xFF));
+
+    float height = bottom - top;
+
+    if (height <= 0.0f)
+        return;
+
+    int y = std::max(0, (int)std::ceil(top - 0.5f));
+    int end = std::min(SoftwareRenderer::Height, (int)std::ceil(bottom - 0.5f));
+
+    if (y >= end)
+        return;
+
+    // 16.16 fixed point texel row
+    const float scale = cel_size * 65536.0f / height;
+    const int32_t step = scale;
+    int32_t v = (y + 0.5f - top) * scale;
+
+#if defined(__SSE2__)
+    const __m128i step4 = _mm_set1_epi32(step * 4);
+    const __m128i last_row = _mm_set1_epi32(cel_size - 1);
+    const __m128i alpha = _mm_set1_epi32(alpha_mask);
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i rows_fixed = _mm_setr_epi32(v, v + step, v + step * 2, v + step * 3);
+
+    for (; y + 4 <= end; y += 4) {
+        // rows fit in 16 bits, so the 16 bit min clamps the rounding overshoot at the bottom
+        __m128i rows = _mm_min_epi16(_mm_srli_epi32(rows_fixed, 16), last_row);
+        rows_fixed = _mm_add_epi32(rows_fixed, step4);
+
+        alignas(16) int32_t index[4];
+        _mm_store_si128((__m128i *)index, rows);
+
+        __m128i colour = _mm_setr_epi32(texels[index[0]], texels[index[1]], texels[index[2]], texels[index[3]]);
+        __m128i *destination = (__m128i *)(column + y);
+
+        if (alpha_test) {
+            __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(colour, alpha), zero);
+            __m128i previous = _mm_loadu_si128(destination);
+
+            colour = _mm_or_si128(_mm_and_si128(transparent, previous), _mm_andnot_si128(transparent, colour));
+        }
+
+        _mm_storeu_si128(destination, colour);
+    }
+
+    v = _mm_cvtsi128_si32(rows_fixed);
+#endif
+
+    for (; y < end; y++, v += step) {
+        uint32_t colour = texels[std::min(v >> 16, cel_size - 1)];
+
+        if (!alpha_test || (colour & alpha_mask))
+            column[y] = colour;
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(const Map &map) {
+    gridWidth = map.getWidth() / CellSize + 1;
+    gridHeight = map.getHeight() / CellSize + 1;
+
+    cellStart.resize(gridWidth * gridHeight + 1);
+    cellFill.resize(gridWidth * gridHeight);
+
+    frame.resize(Width * Height);
+    upload.resize(Width * Height);
+}
+
+void SoftwareRenderer::addWall(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, const CelHandle &texture) {
+    // same collapse as RenderQueue::SubmitWall, every wall is along one axis
+    if (y1 != y2)
+        x2 = x1;
+    else
+        y2 = y1;
+
+    if (x1 == x2 && y1 == y2)
+        return;
+
+    walls.push_back(Wall(x1, y1, x2, y2, TextureCache::GetCelAtlas().getTexels(texture.layer), texture.opaque));
+}
+
+void SoftwareRenderer::addSprite(const raylib::Vector3 &position, float size, const CelHandle &texture) {
+    billboards.push_back(Billboard(position, size, TextureCache::GetCelAtlas().getTexels(texture.layer)));
+}
+
+void SoftwareRenderer::bin() {
+    auto cell_range = [this](const Wall &wall) {
+        int min_x = std::clamp((int)std::min(wall.x1, wall.x2) / CellSize, 0, gridWidth - 1);
+        int max_x = std::clamp((int)std::max(wall.x1, wall.x2) / CellSize, 0, gridWidth - 1);
+        int min_y = std::clamp((int)std::min(wall.y1, wall.y2) / CellSize, 0, gridHeight - 1);
+        int max_y = std::clamp((int)std::max(wall.y1, wall.y2) / CellSize, 0, gridHeight - 1);
+
+        return std::array<int, 4>{min_x, max_x, min_y, max_y};
+    };
+
+    // counting sort, rebuilt every frame so doors and animated walls need no bookkeeping
+    std::fill(std::begin(cellStart), std::end(cellStart), 0);
+
+    for (const auto &wall : walls) {
+        auto [min_x, max_x, min_y, max_y] = cell_range(wall);
+
+        for (int y = min_y; y <= max_y; y++) {
+            for (int x = min_x; x <= max_x; x++) {
+                cellStart[y * gridWidth + x + 1]++;
+            }
+        }
+    }
+
+    for (size_t i = 1; i < cellStart.size(); i++) {
+        cellStart[i] += cellStart[i-1];
+    }
+
+    std::copy(std::begin(cellStart), std::end(cellStart) - 1, std::begin(cellFill));
+    cellWalls.resize(cellStart.back());
+
+    for (size_t i = 0; i < walls.size(); i++) {
+        auto [min_x, max_x, min_y, max_y] = cell_range(walls[i]);
+
+        for (int y = min_y; y <= max_y; y++) {
+            for (int x = min_x; x <= max_x; x++) {
+                cellWalls[cellFill[y * gridWidth + x]++] = i;
+            }
+        }
+    }
+}
+
+size_t SoftwareRenderer::trace(const raylib::Vector2 &origin, const raylib::Vector2 &direction, float max_depth, Hit &nearest, Hit *layers) {
+    const float infinity = std::numeric_limits<float>::infinity();
+    const float epsilon = 0.001f;
+
+    nearest = Hit(infinity, 0.0f, nullptr);
+    size_t layer_count = 0;
+
+    int cell_x = std::floor(origin.x / CellSize);
+    int cell_y = std::floor(origin.y / CellSize);
+
+    if (cell_x < 0 || cell_x >= gridWidth || cell_y < 0 || cell_y >= gridHeight)
+        return 0;
+
+    int step_x = direction.x > 0.0f ? 1 : -1;
+    int step_y = direction.y > 0.0f ? 1 : -1;
+
+    float delta_x = direction.x != 0.0f ? CellSize / std::abs(direction.x) : infinity;
+    float delta_y = direction.y != 0.0f ? CellSize / std::abs(direction.y) : infinity;
+
+    float next_x = direction.x != 0.0f ? ((cell_x + (step_x > 0 ? 1 : 0)) * CellSize - origin.x) / direction.x : infinity;
+    float next_y = direction.y != 0.0f ? ((cell_y + (step_y > 0 ? 1 : 0)) * CellSize - origin.y) / direction.y : infinity;
+
+    float enter = 0.0f;
+
+    while (true) {
+        float exit = std::min(next_x, next_y);
+        int cell = cell_y * gridWidth + cell_x;
+
+        cellsVisited++;
+
+        for (uint32_t i = cellStart[cell]; i < cellStart[cell+1]; i++) {
+            const Wall &wall = walls[cellWalls[i]];
+
+            float depth;
+            float u;
+
+            if (wall.x1 == wall.x2) {
+                if (direction.x == 0.0f)
+                    continue;
+
+                depth = (wall.x1 - origin.x) / direction.x;
+                float y = origin.y + depth * direction.y;
+
+                if (y < std::min(wall.y1, wall.y2) || y > std::max(wall.y1, wall.y2))
+                    continue;
+
+                u = (y - wall.y1) / (wall.y2 - wall.y1);
+            } else {
+                if (direction.y == 0.0f)
+                    continue;
+
+                depth = (wall.y1 - origin.y) / direction.y;
+                float x = origin.x + depth * direction.x;
+
+                if (x < std::min(wall.x1, wall.x2) || x > std::max(wall.x1, wall.x2))
+                    continue;
+
+                u = (x - wall.x1) / (wall.x2 - wall.x1);
+            }
+
+            // a wall spanning several cells is only taken in the cell the ray meets it in
+            if (depth < near_depth || depth < enter - epsilon || depth > exit + epsilon || depth > max_depth)
+                continue;
+
+            if (wall.opaque) {
+                if (depth < nearest.depth)
+                    nearest = Hit(depth, u, &wall);
+            } else if (layer_count < MaxLayers) {
+                layers[layer_count++] = Hit(depth, u, &wall);
+            } else {
+                auto farthest = std::max_element(layers, layers + layer_count, [](const Hit &l, const Hit &r) {
+                    return l.depth < r.depth;
+                });
+
+                if (depth < farthest->depth)
+                    *farthest = Hit(depth, u, &wall);
+            }
+        }
+
+        // cells are visited in depth order, so the first opaque hit is the nearest
+        if (nearest.wall || exit > max_depth)
+            break;
+
+        if (next_x < next_y) {
+            cell_x += step_x;
+            enter = next_x;
+            next_x += delta_x;
+        } else {
+            cell_y += step_y;
+            enter = next_y;
+            next_y += delta_y;
+        }
+
+        if (cell_x < 0 || cell_x >= gridWidth || cell_y < 0 || cell_y >= gridHeight)
+            break;
+    }
+
+    layer_count = std::remove_if(layers, layers + layer_count, [&nearest](const Hit &hit) {
+        return hit.depth >= nearest.depth;
+    }) - layers;
+
+    std::sort(layers, layers + layer_count, [](const Hit &l, const Hit &r) {
+        return l.depth > r.depth;
+    });
+
+    return layer_count;
+}
+
+void SoftwareRenderer::projectSprites(const raylib::Vector3 &eye, const raylib::Vector2 &forward, const raylib::Vector2 &right, float focal) {
+    const float half_width = Width / 2.0f;
+    const float half_height = Height / 2.0f;
+
+    sprites.clear();
+
+    for (const auto &billboard : billboards) {
+        raylib::Vector2 relative(billboard.position.x - eye.x, billboard.position.z - eye.z);
+
+        float depth = relative.DotProduct(forward);
+
+        if (depth < near_depth)
+            continue;
+
+        float size = billboard.size * focal / depth;
+        float centre_x = half_width + relative.DotProduct(right) * focal / depth;
+        float centre_y = half_height - (billboard.position.y - eye.y) * focal / depth;
+
+        if (centre_x + size / 2.0f < 0.0f || centre_x - size / 2.0f > Width)
+            continue;
+
+        sprites.push_back(Sprite(depth, centre_x - size / 2.0f, centre_y - size / 2.0f, size, billboard.texels));
+    }
+
+    std::sort(std::begin(sprites), std::end(sprites), [](const Sprite &l, const Sprite &r) {
+        return l.depth > r.depth;
+    });
+}
+
+void SoftwareRenderer::render(const raylib::Camera3D *camera, const raylib::Color &sky, const raylib::Color &ground, float draw_distance) {
+    const float half_width = Width / 2.0f;
+    const float half_height = Height / 2.0f;
+
+    // same vertical field of view as the GPU path, square pixels make it the horizontal focal length too
+    const float focal = half_height / std::tan(camera->fovy * DEG2RAD / 2.0f);
+    const float max_depth = draw_distance > 0.0f ? draw_distance : std::numeric_limits<float>::infinity();
+
+    raylib::Vector3 eye = camera->position;
+    raylib::Vector2 forward = raylib::Vector2(camera->target.x - eye.x, camera->target.z - eye.z).Normalize();
+    raylib::Vector2 right(-forward.y, forward.x);
+
+    const uint32_t sky_colour = pack(sky);
+    const uint32_t ground_colour = pack(ground);
+
+    wallCount = walls.size();
+    spriteCount = billboards.size();
+    cellsVisited = 0;
+
+    bin();
+    projectSprites(eye, forward, right, focal);
+
+    Hit nearest;
+    std::array<Hit, MaxLayers> layers;
+
+    for (int x = 0; x < Width; x++) {
+        uint32_t *column = frame.data() + x * Height;
+
+        std::fill(column, column + Height / 2, sky_colour);
+        std::fill(column + Height / 2, column + Height, ground_colour);
+
+        float offset = (x + 0.5f - half_width) / focal;
+        raylib::Vector2 direction = forward + right * offset;
+
+        size_t layer_count = trace(raylib::Vector2(eye.x, eye.z), direction, max_depth, nearest, layers.data());
+
+        auto draw_wall = [&](const Hit &hit) {
+            int texel_column = std::min((int)(hit.u * cel_size), cel_size - 1);
+
+            float top = half_height - (wall_height - eye.y) * focal / hit.depth;
+            float bottom = half_height + eye.y * focal / hit.depth;
+
+            draw_column(column, hit.wall->texels + texel_column * cel_size, top, bottom, !hit.wall->opaque);
+        };
+
+        if (nearest.wall)
+            draw_wall(nearest);
+
+        depth[x] = nearest.depth;
+
+        // alpha tested walls and sprites in front of the opaque wall, merged far to near
+        size_t layer = 0;
+        size_t sprite = 0;
+
+        while (true) {
+            while (sprite < sprites.size() && (sprites[sprite].depth >= depth[x] || x + 0.5f < sprites[sprite].left || x + 0.5f >= sprites[sprite].left + sprites[sprite].size))
+                sprite++;
+
+            bool have_layer = layer < layer_count;
+            bool have_sprite = sprite < sprites.size();
+
+            if (!have_layer && !have_sprite)
+                break;
+
+            if (have_layer && (!have_sprite || layers[layer].depth >= sprites[sprite].depth)) {
+                draw_wall(layers[layer++]);
+            } else {
+                const auto &current = sprites[sprite++];
+                int texel_column = std::min((int)((x + 0.5f - current.left) / current.size * cel_size), cel_size - 1);
+
+                draw_column(column, current.texels + texel_column * cel_size, current.top, current.top + current.size, true);
+            }
+        }
+    }
+
+    walls.clear();
+    billboards.clear();
+}
+
+void SoftwareRenderer::draw(int scale) {
+    auto &texture = frame_texture();
+
+    for (int x = 0; x < Width; x++) {
+        const uint32_t *column = frame.data() + x * Height;
+
+        for (int y = 0; y < Height; y++) {
+            upload[y * Width + x] = column[y];
+        }
+    }
+
+    UpdateTexture(texture, upload.data());
+
+    DrawTexturePro(texture, raylib::Rectangle(0, 0, Width, Height), raylib::Rectangle(0, 0, Width * scale, Height * scale), Vector2(0, 0), 0.0f, WHITE);
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+
+}
@@ -0,0 +1,124 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+#include <cstdint>
+#include <array>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+#include "CelAtlas.h"
+#include "Map.h"
+
+// CPU column raycaster for the axis aligned walls, draws a 320x200 frame and uploads it once
+class SoftwareRenderer {
+public:
+    static const int Width = 320;
+    static const int Height = 200;
+    static const int CellSize = 16;
+    // alpha tested walls kept per column in front of the nearest opaque wall
+    static const int MaxLayers = 8;
+private:
+    struct Wall {
+        float x1;
+        float y1;
+        float x2;
+        float y2;
+        const uint32_t *texels;
+        bool opaque;
+    };
+
+    struct Billboard {
+        raylib::Vector3 position;
+        float size;
+        const uint32_t *texels;
+    };
+
+    // a billboard projected to the screen
+    struct Sprite {
+        float depth;
+        float left;
+        float top;
+        float size;
+        const uint32_t *texels;
+    };
+
+    struct Hit {
+        float depth;
+        float u;
+        const Wall *wall;
+    };
+
+    std::vector<Wall> walls;
+    std::vector<Billboard> billboards;
+    std::vector<Sprite> sprites;
+
+    // walls binned by grid cell, cellStart has one extra entry so a cell is cellStart[i]..cellStart[i+1]
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellFill;
+    std::vector<uint32_t> cellWalls;
+    int gridWidth;
+    int gridHeight;
+
+    // column major, Height pixels per column
+    std::vector<uint32_t> frame;
+    std::vector<uint32_t> upload;
+    std::array<float, Width> depth;
+
+    size_t wallCount = 0;
+    size_t spriteCount = 0;
+    size_t cellsVisited = 0;
+
+    void bin();
+    // nearest opaque wall, and the alpha tested walls in front of it far to near
+    size_t trace(const raylib::Vector2 &origin, const raylib::Vector2 &direction, float max_depth, Hit &nearest, Hit *layers);
+    void projectSprites(const raylib::Vector3 &eye, const raylib::Vector2 &forward, const raylib::Vector2 &right, float focal);
+public:
+    SoftwareRenderer(const Map &map);
+
+    SoftwareRenderer(const SoftwareRenderer &) = delete;
+    SoftwareRenderer &operator=(const SoftwareRenderer &) = delete;
+
+    void addWall(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, const CelHandle &texture);
+    void addSprite(const raylib::Vector3 &position, float size, const CelHandle &texture);
+
+    // raycasts everything added since the last render, 0 draw distance is unlimited
+    void render(const raylib::Camera3D *camera, const raylib::Color &sky, const raylib::Color &ground, float draw_distance);
+
+    // uploads the frame and draws it over the 320x200 screen at scale
+    void draw(int scale);
+
+    // counts from the last render
+    size_t getWallCount() const {
+        return wallCount;
+    }
+
+    size_t getSpriteCount() const {
+        return spriteCount;
+    }
+
+    size_t getCellsVisited() const {
+        return cellsVisited;
+    }
+
+    ~SoftwareRenderer();
+};
+
+#endif //SOFTWARERENDERER_H
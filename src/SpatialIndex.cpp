@@ -0,0 +1,429 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+#include "SpatialIndex.h"
+#include "Entity.h"
+#include "World.h"
+
+static const float wall_height = 12.0f;
+
+// billboards are hit as spheres reaching this far past their bounds
+static const float hit_radius = 6.0f;
+
+// every segment that has an entity, in map order
+static std::vector<SpatialIndex::Entry> find_entries(const Map &map, World *world) {
+    const auto &segments = map.getSegments();
+    std::vector<SpatialIndex::Entry> entries;
+
+    for (uint32_t i = 0; i < segments.size(); i++) {
+        Entity *entity = world->getEntity(segments[i].id);
+
+        if (entity)
+            entries.push_back(SpatialIndex::Entry(i, entity));
+    }
+
+    return entries;
+}
+
+SpatialIndex::SpatialIndex(const Map &map, World *world) : SpatialIndex(map, find_entries(map, world)) {
+}
+
+SpatialIndex::SpatialIndex(const Map &map, const std::vector<Entry> &segment_entries) : arrays(map.getSegmentArrays()), entries(segment_entries) {
+    width = map.getWidth() / CellSize + 1;
+    height = map.getHeight() / CellSize + 1;
+
+    cells.resize(width * height);
+
+    for (const auto &entry : entries)
+        colliders.push_back(getCollider(entry));
+
+    stamps.resize(entries.size(), 0);
+
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        auto range = getRange(i);
+
+        insert(i, range);
+
+        if (entries[i].entity->getPosition())
+            moving.push_back(std::make_pair(i, range));
+    }
+}
+
+SpatialIndex::Range SpatialIndex::getRange(float min_x, float min_y, float max_x, float max_y) const {
+    // anything off the grid lands in the edge cells, queries are clamped the same way so still find it
+    return Range(
+        std::clamp((int)std::floor(min_x / CellSize), 0, width - 1),
+        std::clamp((int)std::floor(min_y / CellSize), 0, height - 1),
+        std::clamp((int)std::floor(max_x / CellSize), 0, width - 1),
+        std::clamp((int)std::floor(max_y / CellSize), 0, height - 1)
+    );
+}
+
+SpatialIndex::Range SpatialIndex::getRange(uint32_t entry) const {
+    const auto &collider = colliders[entry];
+
+    if (collider.shape == Collider::Shape::Circle)
+        return getRange(collider.x - collider.radius, collider.y - collider.radius, collider.x + collider.radius, collider.y + collider.radius);
+
+    uint32_t segment = entries[entry].segment;
+
+    return getRange(std::min(arrays.x1[segment], arrays.x2[segment]), std::min(arrays.y1[segment], arrays.y2[segment]), std::max(arrays.x1[segment], arrays.x2[segment]), std::max(arrays.y1[segment], arrays.y2[segment]));
+}
+
+SpatialIndex::Collider SpatialIndex::getCollider(const Entry &entry) const {
+    auto collision = entry.entity->collide();
+    auto bounds_if = entry.entity->getBounds();
+
+    if (bounds_if) {
+        const auto &[centre, radius] = *bounds_if;
+        return Collider(Collider::Shape::Circle, collision, centre.x, centre.y, radius);
+    }
+
+    uint32_t segment = entry.segment;
+
+    switch (arrays.orientation[segment]) {
+        case SegmentArrays::Orientation::Horizontal:
+            return Collider(Collider::Shape::Horizontal, collision, 0.0f, arrays.y1[segment], 0.0f, std::min(arrays.x1[segment], arrays.x2[segment]), std::max(arrays.x1[segment], arrays.x2[segment]));
+        case SegmentArrays::Orientation::Vertical:
+            return Collider(Collider::Shape::Vertical, collision, arrays.x1[segment], 0.0f, 0.0f, std::min(arrays.y1[segment], arrays.y2[segment]), std::max(arrays.y1[segment], arrays.y2[segment]));
+        case SegmentArrays::Orientation::Diagonal:
+            break;
+    }
+
+    return Collider(Collider::Shape::None, collision);
+}
+
+std::optional<HitShape> SpatialIndex::getHitShape(uint32_t entry) const {
+    auto shape = entries[entry].entity->getHitShape();
+    const auto &collider = colliders[entry];
+
+    // plain walls have no ray test of their own but still stop shots
+    if (!shape && collider.shape != Collider::Shape::Circle && collider.collision == Collision::Block) {
+        uint32_t segment = entries[entry].segment;
+        return HitShape::Quad(arrays.x1[segment], arrays.y1[segment], arrays.x2[segment], arrays.y2[segment], wall_height);
+    }
+
+    return shape;
+}
+
+void SpatialIndex::insert(uint32_t entry, const Range &range) {
+    for (int y = range.y1; y <= range.y2; y++) {
+        for (int x = range.x1; x <= range.x2; x++) {
+            cells[y * width + x].push_back(entry);
+        }
+    }
+}
+
+void SpatialIndex::remove(uint32_t entry, const Range &range) {
+    for (int y = range.y1; y <= range.y2; y++) {
+        for (int x = range.x1; x <= range.x2; x++) {
+            auto &cell = cells[y * width + x];
+            cell.erase(std::find(std::begin(cell), std::end(cell), entry));
+        }
+    }
+}
+
+void SpatialIndex::gather(const Range &range, std::vector<uint32_t> &found) const {
+    for (int y = range.y1; y <= range.y2; y++) {
+        for (int x = range.x1; x <= range.x2; x++) {
+            const auto &cell = cells[y * width + x];
+            found.insert(std::end(found), std::begin(cell), std::end(cell));
+        }
+    }
+}
+
+void SpatialIndex::order(std::vector<uint32_t> &found) {
+    // entries are numbered in map order, sorting restores it for callers that stop at the first hit
+    std::sort(std::begin(found), std::end(found));
+    found.erase(std::unique(std::begin(found), std::end(found)), std::end(found));
+}
+
+std::vector<SpatialIndex::Entry> SpatialIndex::collect(std::vector<uint32_t> &found) const {
+    order(found);
+
+    std::vector<Entry> result;
+    result.reserve(found.size());
+
+    for (auto entry : found) {
+        result.push_back(entries[entry]);
+    }
+
+    return result;
+}
+
+void SpatialIndex::update() {
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        if (entries[i].entity->takeChanged())
+            colliders[i] = getCollider(entries[i]);
+    }
+
+    for (auto &[entry, range] : moving) {
+        colliders[entry] = getCollider(entries[entry]);
+
+        auto new_range = getRange(entry);
+
+        if (new_range == range)
+            continue;
+
+        remove(entry, range);
+        insert(entry, new_range);
+        range = new_range;
+    }
+}
+
+std::vector<SpatialIndex::Entry> SpatialIndex::queryBox(const raylib::Rectangle &area) const {
+    auto range = getRange(area.x, area.y, area.x + area.width, area.y + area.height);
+
+    std::vector<uint32_t> found;
+    gather(range, found);
+
+    return collect(found);
+}
+
+std::vector<SpatialIndex::Entry> SpatialIndex::queryRadius(const raylib::Vector2 &centre, float radius) const {
+    return queryBox(raylib::Rectangle(centre.x - radius, centre.y - radius, radius * 2, radius * 2));
+}
+
+std::vector<SpatialIndex::Contact> SpatialIndex::collide(const raylib::Vector2 &position, float radius) const {
+    auto range = getRange(position.x - radius, position.y - radius, position.x + radius, position.y + radius);
+
+    std::vector<uint32_t> found;
+    gather(range, found);
+    order(found);
+
+    // lines are reached in whole units
+    const int north = position.y - radius;
+    const int south = position.y + radius;
+    const int west = position.x - radius;
+    const int east = position.x + radius;
+
+    std::vector<Contact> contacts;
+
+    for (auto entry : found) {
+        const auto &collider = colliders[entry];
+
+        bool touching = false;
+        bool line = false;
+
+        switch (collider.shape) {
+            case Collider::Shape::Circle:
+                touching = collider.radius + radius > position.Distance(raylib::Vector2(collider.x, collider.y));
+                break;
+            case Collider::Shape::Horizontal:
+                line = position.x >= collider.min && position.x <= collider.max;
+                touching = line && ((collider.y < position.y && collider.y > north) || (collider.y > position.y && collider.y < south));
+                break;
+            case Collider::Shape::Vertical:
+                line = position.y >= collider.min && position.y <= collider.max;
+                touching = line && ((collider.x < position.x && collider.x > west) || (collider.x > position.x && collider.x < east));
+                break;
+            case Collider::Shape::None:
+                break;
+        }
+
+        if (!touching)
+            continue;
+
+        contacts.push_back(Contact(entries[entry].entity, collider.collision));
+
+        if (line)
+            break;
+    }
+
+    return contacts;
+}
+
+template <typename Visit>
+void SpatialIndex::walk(const raylib::Vector2 &start, const raylib::Vector2 &end, Visit visit) const {
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // in cell units, t runs from 0 at start to 1 at end
+    const raylib::Vector2 from = start / CellSize;
+    const raylib::Vector2 to = end / CellSize;
+    const raylib::Vector2 delta = to - from;
+
+    int x = std::floor(from.x);
+    int y = std::floor(from.y);
+
+    const int step_x = delta.x > 0.0f ? 1 : -1;
+    const int step_y = delta.y > 0.0f ? 1 : -1;
+
+    const int steps = std::abs((int)std::floor(to.x) - x) + std::abs((int)std::floor(to.y) - y);
+
+    const float delta_x = delta.x != 0.0f ? std::fabs(1.0f / delta.x) : infinity;
+    const float delta_y = delta.y != 0.0f ? std::fabs(1.0f / delta.y) : infinity;
+
+    float next_x = delta.x > 0.0f ? (x + 1 - from.x) * delta_x : delta.x < 0.0f ? (from.x - x) * delta_x : infinity;
+    float next_y = delta.y > 0.0f ? (y + 1 - from.y) * delta_y : delta.y < 0.0f ? (from.y - y) * delta_y : infinity;
+
+    for (int i = 0; i <= steps; i++) {
+        if (!visit(x, y, std::min(next_x, next_y)))
+            return;
+
+        if (next_x < next_y) {
+            x += step_x;
+            next_x += delta_x;
+        } else {
+            y += step_y;
+            next_y += delta_y;
+        }
+    }
+}
+
+std::vector<SpatialIndex::Entry> SpatialIndex::querySegment(const raylib::Vector2 &start, const raylib::Vector2 &end, float radius) const {
+    std::vector<uint32_t> found;
+
+    walk(start, end, [&](int x, int y, float) {
+        gather(getRange(x * CellSize - radius, y * CellSize - radius, (x + 1) * CellSize + radius, (y + 1) * CellSize + radius), found);
+
+        return true;
+    });
+
+    return collect(found);
+}
+
+std::vector<SpatialIndex::Hit> SpatialIndex::castRay(const raylib::Ray &ray, float range) const {
+    // the direction is normalised, so t along the horizontal walk times range is the distance along the ray
+    raylib::Vector2 start(ray.position.x, ray.position.z);
+    raylib::Vector2 end = start + raylib::Vector2(ray.direction.x, ray.direction.z) * range;
+
+    stamp++;
+    std::vector<Hit> hits;
+    float blocked = range;
+
+    walk(start, end, [&](int x, int y, float exit) {
+        auto cell_range = getRange(x * CellSize - hit_radius, y * CellSize - hit_radius, (x + 1) * CellSize + hit_radius, (y + 1) * CellSize + hit_radius);
+
+        for (int cell_y = cell_range.y1; cell_y <= cell_range.y2; cell_y++) {
+            for (int cell_x = cell_range.x1; cell_x <= cell_range.x2; cell_x++) {
+                for (auto entry : cells[cell_y * width + cell_x]) {
+                    if (stamps[entry] == stamp)
+                        continue;
+
+                    stamps[entry] = stamp;
+
+                    auto shape = getHitShape(entry);
+                    auto collision_if = shape ? shape->collide(ray) : std::nullopt;
+
+                    if (!collision_if || collision_if->GetDistance() >= range)
+                        continue;
+
+                    Entity *entity = entries[entry].entity;
+                    hits.push_back(Hit(entity, *collision_if));
+
+                    if (entity->collide() == Collision::Block)
+                        blocked = std::min(blocked, collision_if->GetDistance());
+                }
+            }
+        }
+
+        // every hit closer than where the walk leaves this cell has been found
+        return blocked > exit * range;
+    });
+
+    std::sort(std::begin(hits), std::end(hits), [](const Hit &l, const Hit &r) {
+        return l.collision.GetDistance() < r.collision.GetDistance();
+    });
+
+    auto blocker = std::find_if(std::begin(hits), std::end(hits), [](const Hit &hit) {
+        return hit.entity->collide() == Collision::Block;
+    });
+
+    if (blocker != std::end(hits))
+        hits.erase(blocker + 1, std::end(hits));
+
+    return hits;
+}
+
+std::vector<std::optional<SpatialIndex::Hit>> SpatialIndex::castPacket(const RayPacket &packet, float range) const {
+    const auto &centre = packet.getCentre();
+
+    raylib::Vector2 start(centre.position.x, centre.position.z);
+    raylib::Vector2 end = start + raylib::Vector2(centre.direction.x, centre.direction.z) * range;
+
+    const float spread = packet.getHorizontalSpread();
+
+    stamp++;
+
+    std::array<float, RayPacket::MaxRays> nearest;
+    std::array<int64_t, RayPacket::MaxRays> winners;
+    std::array<float, RayPacket::MaxRays> distances;
+
+    nearest.fill(range);
+    winners.fill(-1);
+
+    walk(start, end, [&](int x, int y, float exit) {
+        // the other rays drift from the centre one with distance, so the cells around it widen as the walk goes on
+        const float radius = hit_radius + std::min(exit, 1.0f) * range * spread;
+        auto cell_range = getRange(x * CellSize - radius, y * CellSize - radius, (x + 1) * CellSize + radius, (y + 1) * CellSize + radius);
+
+        for (int cell_y = cell_range.y1; cell_y <= cell_range.y2; cell_y++) {
+            for (int cell_x = cell_range.x1; cell_x <= cell_range.x2; cell_x++) {
+                for (auto entry : cells[cell_y * width + cell_x]) {
+                    if (stamps[entry] == stamp)
+                        continue;
+
+                    stamps[entry] = stamp;
+
+                    auto shape = getHitShape(entry);
+
+                    if (!shape)
+                        continue;
+
+                    packet.intersect(*shape, distances.data());
+
+                    for (int ray = 0; ray < packet.getCount(); ray++) {
+                        if (distances[ray] < nearest[ray]) {
+                            nearest[ray] = distances[ray];
+                            winners[ray] = entry;
+                        }
+                    }
+                }
+            }
+        }
+
+        return std::any_of(std::begin(nearest), std::begin(nearest) + packet.getCount(), [&](float distance) {
+            return distance > exit * range;
+        });
+    });
+
+    std::vector<std::optional<Hit>> hits(packet.getCount());
+
+    // the winners are rerun through HitShape::collide for the hit point and normal
+    for (int ray = 0; ray < packet.getCount(); ray++) {
+        if (winners[ray] < 0)
+            continue;
+
+        auto collision_if = getHitShape(winners[ray])->collide(packet.getRay(ray));
+
+        if (collision_if)
+            hits[ray] = Hit(entries[winners[ray]].entity, *collision_if);
+    }
+
+    return hits;
+}
+
+SpatialIndex::~SpatialIndex() {
+
+}
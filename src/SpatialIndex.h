@@ -0,0 +1,152 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+#include "Map.h"
+#include "Entity.h"
+#include "RayPacket.h"
+
+class World;
+
+// Uniform grid over the segments that have an entity, built once the world is populated. Entities with a
+// position move, update() re-buckets them when they cross into other cells.
+class SpatialIndex {
+public:
+    struct Entry {
+        uint32_t segment;
+        Entity *entity;
+    };
+
+    struct Hit {
+        Entity *entity;
+        raylib::RayCollision collision;
+    };
+
+    struct Contact {
+        Entity *entity;
+        Collision collision;
+    };
+private:
+    // What movement tests against, copied out of the entity when it moves or reports a change. Walls are axis
+    // aligned lines, anything with bounds is a circle, other segments never collide.
+    struct Collider {
+        enum class Shape : uint8_t {
+            None,
+            Circle,
+            Horizontal,
+            Vertical,
+        };
+
+        Shape shape;
+        Collision collision;
+
+        // circle centre, a horizontal line sits at y and a vertical one at x
+        float x;
+        float y;
+        float radius;
+
+        // line extent along its axis
+        float min;
+        float max;
+    };
+
+    struct Range {
+        int x1;
+        int y1;
+        int x2;
+        int y2;
+
+        bool operator==(const Range &other) const = default;
+    };
+
+    const SegmentArrays &arrays;
+
+    std::vector<Entry> entries;
+    std::vector<Collider> colliders;
+    std::vector<std::vector<uint32_t>> cells;
+
+    // entries with a position and the cells they were last bucketed in
+    std::vector<std::pair<uint32_t, Range>> moving;
+
+    // the cast an entry was last tested in, so a cast skips repeats without clearing anything
+    mutable std::vector<uint32_t> stamps;
+    mutable uint32_t stamp = 0;
+
+    int width;
+    int height;
+
+    Range getRange(float min_x, float min_y, float max_x, float max_y) const;
+    Range getRange(uint32_t entry) const;
+
+    Collider getCollider(const Entry &entry) const;
+
+    void insert(uint32_t entry, const Range &range);
+    void remove(uint32_t entry, const Range &range);
+
+    // appends every entry bucketed in range, order() sorts out the repeats
+    void gather(const Range &range, std::vector<uint32_t> &found) const;
+    static void order(std::vector<uint32_t> &found);
+
+    std::vector<Entry> collect(std::vector<uint32_t> &found) const;
+
+    std::optional<HitShape> getHitShape(uint32_t entry) const;
+
+    // visits the cells a line crosses in order, with how far along the line each is left
+    template <typename Visit>
+    void walk(const raylib::Vector2 &start, const raylib::Vector2 &end, Visit visit) const;
+public:
+    static const int CellSize = 10;
+
+    SpatialIndex(const Map &map, World *world);
+    // entries in map order, built without a World
+    SpatialIndex(const Map &map, const std::vector<Entry> &segment_entries);
+
+    void update();
+
+    // every entry in map order
+    const std::vector<Entry> &getEntries() const {
+        return entries;
+    }
+
+    // entries bucketed in any cell the query touches, in map order, callers still do their exact tests
+    std::vector<Entry> queryBox(const raylib::Rectangle &area) const;
+    std::vector<Entry> queryRadius(const raylib::Vector2 &centre, float radius) const;
+    // cells within radius of the line from start to end
+    std::vector<Entry> querySegment(const raylib::Vector2 &start, const raylib::Vector2 &end, float radius) const;
+
+    // what a circle at position runs into, in map order, ending with the first line it reaches
+    std::vector<Contact> collide(const raylib::Vector2 &position, float radius) const;
+
+    // hits within range nearest first, ending with the first one that blocks
+    std::vector<Hit> castRay(const raylib::Ray &ray, float range) const;
+
+    // nearest hit within range for every ray of the packet, each candidate is tested against all the rays at once
+    std::vector<std::optional<Hit>> castPacket(const RayPacket &packet, float range) const;
+
+    ~SpatialIndex();
+};
+
+#endif //SPATIALINDEX_H
@@ -0,0 +1,319 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <cstring>
+#include <algorithm>
+
+#include "StaticGeometry.h"
+#include "Entity.h"
+#include "World.h"
+#include "VisibilitySet.h"
+#include "RenderQueue.h"
+
+static const float wall_height = 12.0f;
+static const int quad_vertices = 6;
+
+StaticGeometry::StaticGeometry(const Map &map, World *world) : segments(map.getSegments()) {
+    opaqueMaterial = LoadMaterialDefault();
+    opaqueMaterial.shader = RenderQueue::GetOpaqueShader();
+    alphaMaterial = LoadMaterialDefault();
+    alphaMaterial.shader = RenderQueue::GetAlphaTestShader();
+
+    animatedOpaqueMaterial = LoadMaterialDefault();
+    animatedOpaqueMaterial.shader = RenderQueue::GetAnimatedWallShader(false);
+    animatedAlphaMaterial = LoadMaterialDefault();
+    animatedAlphaMaterial.shader = RenderQueue::GetAnimatedWallShader(true);
+    animatedOpaqueFrameLocation = GetShaderLocation(animatedOpaqueMaterial.shader, "frameCounter");
+    animatedAlphaFrameLocation = GetShaderLocation(animatedAlphaMaterial.shader, "frameCounter");
+
+    for (size_t i = 0; i < segments.size(); i++) {
+        Entity *entity = world->getEntity(segments[i].id);
+
+        if (!entity)
+            continue;
+
+        auto textures = entity->getWallTextures();
+
+        if (textures.empty())
+            continue;
+
+        const CelHandle *current = entity->getWallTexture();
+        auto animation = entity->getWallAnimation();
+        BatchKey current_key = getBatchKey(segments[i], current, animation.has_value());
+
+        auto bounds = Culling::GetSegmentBounds(segments[i]);
+
+        DynamicWall dynamic_wall(entity, current->layer, {}, {});
+
+        // a wall needs one slot in each batch it can be shown from
+        for (const auto *texture : textures) {
+            BatchKey key = getBatchKey(segments[i], texture, animation.has_value());
+
+            if (std::find(std::begin(dynamic_wall.keys), std::end(dynamic_wall.keys), key) != std::end(dynamic_wall.keys))
+                continue;
+
+            auto &batch = batches[key];
+
+            batch.texture = texture->atlas;
+            batch.opaque = texture->opaque;
+            batch.animated = animation.has_value();
+            batch.potentiallyVisible = true;
+            batch.centre = raylib::Vector2((std::get<3>(key) + 0.5f) * ChunkSize, (std::get<4>(key) + 0.5f) * ChunkSize);
+
+            if (batch.quads.empty())
+                batch.bounds = bounds;
+
+            batch.bounds.min = Vector3Min(batch.bounds.min, bounds.min);
+            batch.bounds.max = Vector3Max(batch.bounds.max, bounds.max);
+
+            batch.quads.push_back(Quad(i, key == current_key ? current : texture, key == current_key, animation.value_or(CelAnimation(1, 1))));
+
+            dynamic_wall.keys.push_back(key);
+            dynamic_wall.slots.push_back(batch.quads.size()-1);
+
+            if (animation && animation->oneShot)
+                oneShotWalls.push_back(OneShotWall(entity, key, batch.quads.size()-1));
+        }
+
+        // walls that only ever show one texture never need patching
+        if (textures.size() > 1)
+            dynamicWalls.push_back(dynamic_wall);
+    }
+
+    for (auto &[key, batch] : batches) {
+        batch.mesh = Mesh();
+        batch.mesh.vertexCount = batch.quads.size() * quad_vertices;
+        batch.mesh.triangleCount = batch.quads.size() * 2;
+        batch.mesh.vertices = (float *)MemAlloc(batch.mesh.vertexCount * 3 * sizeof(float));
+        batch.mesh.texcoords = (float *)MemAlloc(batch.mesh.vertexCount * 2 * sizeof(float));
+
+        for (size_t quad = 0; quad < batch.quads.size(); quad++) {
+            writeQuad(batch, quad, false);
+        }
+
+        if (batch.animated) {
+            batch.mesh.texcoords2 = (float *)MemAlloc(batch.mesh.vertexCount * 2 * sizeof(float));
+            batch.mesh.normals = (float *)MemAlloc(batch.mesh.vertexCount * 3 * sizeof(float));
+
+            for (size_t quad = 0; quad < batch.quads.size(); quad++) {
+                writeAnimation(batch, quad, false);
+            }
+        }
+
+        UploadMesh(&batch.mesh, true);
+    }
+}
+
+StaticGeometry::BatchKey StaticGeometry::getBatchKey(const Segment &segment, const CelHandle *cel, bool animated) const {
+    // chunks are the unit of culling, opaque chunks are also drawn front to back
+    uint16_t chunk_x = std::min(segment.x1, segment.x2) / ChunkSize;
+    uint16_t chunk_y = std::min(segment.y1, segment.y2) / ChunkSize;
+
+    return BatchKey(cel->atlas.id, cel->opaque, animated, chunk_x, chunk_y);
+}
+
+const Material &StaticGeometry::getMaterial(const Batch &batch) const {
+    if (batch.animated)
+        return batch.opaque ? animatedOpaqueMaterial : animatedAlphaMaterial;
+
+    return batch.opaque ? opaqueMaterial : alphaMaterial;
+}
+
+void StaticGeometry::writeQuad(Batch &batch, size_t quad, bool upload) {
+    const auto &[segment_index, cel, visible, animation] = batch.quads[quad];
+    const auto &segment = segments[segment_index];
+
+    float x1 = segment.x1;
+    float y1 = segment.y1;
+    float x2 = segment.x2;
+    float y2 = segment.y2;
+
+    if (segment.y1 != segment.y2)
+        x2 = x1;
+    else
+        y2 = y1;
+
+    const float vertices[quad_vertices][3] = {
+        {x1, 0, y1},
+        {x2, 0, y2},
+        {x2, wall_height, y2},
+        {x2, wall_height, y2},
+        {x1, wall_height, y1},
+        {x1, 0, y1},
+    };
+
+    const float u0 = cel->uv.x;
+    const float u1 = cel->uv.x + cel->uv.width;
+    const float v0 = cel->uv.y;
+    const float v1 = cel->uv.y + cel->uv.height;
+
+    const float texcoords[quad_vertices][2] = {
+        {u0, v1},
+        {u1, v1},
+        {u1, v0},
+        {u1, v0},
+        {u0, v0},
+        {u0, v1},
+    };
+
+    float *vertex_data = batch.mesh.vertices + (quad * quad_vertices * 3);
+    float *texcoord_data = batch.mesh.texcoords + (quad * quad_vertices * 2);
+
+    if (visible) {
+        std::memcpy(vertex_data, vertices, sizeof(vertices));
+    } else {
+        // hidden slots collapse to a point so they rasterise nothing
+        for (int i = 0; i < quad_vertices; i++) {
+            std::memcpy(vertex_data + (i * 3), vertices[0], sizeof(vertices[0]));
+        }
+    }
+
+    std::memcpy(texcoord_data, texcoords, sizeof(texcoords));
+
+    if (upload) {
+        UpdateMeshBuffer(batch.mesh, 0, vertex_data, sizeof(vertices), quad * sizeof(vertices));
+        UpdateMeshBuffer(batch.mesh, 1, texcoord_data, sizeof(texcoords), quad * sizeof(texcoords));
+    }
+}
+
+void StaticGeometry::writeAnimation(Batch &batch, size_t quad, bool upload) {
+    const auto &animation = batch.quads[quad].animation;
+
+    // walls are unlit, so the normal is free to say whether the animation is one shot and when it started
+    const float start = animation.start ? (float)(*animation.start & 0x7FFFFFFF) : -1.0f;
+
+    float *texcoord2_data = batch.mesh.texcoords2 + (quad * quad_vertices * 2);
+    float *normal_data = batch.mesh.normals + (quad * quad_vertices * 3);
+
+    for (int i = 0; i < quad_vertices; i++) {
+        texcoord2_data[i * 2] = animation.frames;
+        texcoord2_data[i * 2 + 1] = animation.frameRate;
+
+        normal_data[i * 3] = animation.oneShot ? 1.0f : 0.0f;
+        normal_data[i * 3 + 1] = start;
+        normal_data[i * 3 + 2] = 0.0f;
+    }
+
+    // only the start changes after the mesh is built
+    if (upload)
+        UpdateMeshBuffer(batch.mesh, 2, normal_data, quad_vertices * 3 * sizeof(float), quad * quad_vertices * 3 * sizeof(float));
+}
+
+void StaticGeometry::update(const uint64_t *potentially_visible, uint64_t frame_count) {
+    // wraps instead of overflowing the int uniform
+    frameCounter = frame_count & 0x7FFFFFFF;
+
+    // the row only changes when the camera crosses into another cell
+    if (potentially_visible != potentiallyVisible) {
+        for (auto &[key, batch] : batches) {
+            batch.potentiallyVisible = !potentially_visible || std::any_of(std::begin(batch.quads), std::end(batch.quads), [&](const auto &quad) {
+                return VisibilitySet::Test(potentially_visible, segments[quad.segment].index);
+            });
+        }
+
+        potentiallyVisible = potentially_visible;
+    }
+
+    for (auto &dynamic_wall : dynamicWalls) {
+        const CelHandle *current = dynamic_wall.entity->getWallTexture();
+
+        if (current->layer == dynamic_wall.current)
+            continue;
+
+        for (size_t i = 0; i < dynamic_wall.keys.size(); i++) {
+            auto &batch = batches.at(dynamic_wall.keys[i]);
+            auto &quad = batch.quads[dynamic_wall.slots[i]];
+
+            quad.visible = (dynamic_wall.keys[i] == getBatchKey(segments[quad.segment], current, batch.animated));
+            if (quad.visible)
+                quad.cel = current;
+
+            writeQuad(batch, dynamic_wall.slots[i], true);
+        }
+
+        dynamic_wall.current = current->layer;
+    }
+
+    for (const auto &wall : oneShotWalls) {
+        auto &batch = batches.at(wall.key);
+        auto &quad = batch.quads[wall.slot];
+        auto animation = *wall.entity->getWallAnimation();
+
+        if (animation.start == quad.animation.start)
+            continue;
+
+        quad.animation = animation;
+        writeAnimation(batch, wall.slot, true);
+    }
+}
+
+size_t StaticGeometry::drawOpaque(const raylib::Camera3D *camera, const Frustum &frustum) const {
+    auto camera_position = camera->GetPosition();
+    raylib::Vector2 position(camera_position.x, camera_position.z);
+
+    std::vector<std::pair<float, const Batch *>> opaque;
+
+    for (const auto &[key, batch] : batches) {
+        if (batch.opaque && batch.potentiallyVisible && frustum.containsBox(batch.bounds))
+            opaque.push_back(std::make_pair(batch.centre.DistanceSqr(position), &batch));
+    }
+
+    // front to back so nearer chunks fill the depth buffer first
+    std::sort(std::begin(opaque), std::end(opaque), [](const auto &l, const auto &r) {
+        return l.first < r.first;
+    });
+
+    SetShaderValue(animatedOpaqueMaterial.shader, animatedOpaqueFrameLocation, &frameCounter, SHADER_UNIFORM_INT);
+
+    for (const auto &[distance, batch] : opaque) {
+        const auto &material = getMaterial(*batch);
+        material.maps[MATERIAL_MAP_DIFFUSE].texture = batch->texture;
+        DrawMesh(batch->mesh, material, MatrixIdentity());
+    }
+
+    return opaque.size();
+}
+
+size_t StaticGeometry::drawAlphaTested(const Frustum &frustum) const {
+    size_t drawn = 0;
+
+    SetShaderValue(animatedAlphaMaterial.shader, animatedAlphaFrameLocation, &frameCounter, SHADER_UNIFORM_INT);
+
+    for (const auto &[key, batch] : batches) {
+        if (batch.opaque || !batch.potentiallyVisible || !frustum.containsBox(batch.bounds))
+            continue;
+
+        const auto &material = getMaterial(batch);
+        material.maps[MATERIAL_MAP_DIFFUSE].texture = batch.texture;
+        DrawMesh(batch.mesh, material, MatrixIdentity());
+        drawn++;
+    }
+
+    return drawn;
+}
+
+StaticGeometry::~StaticGeometry() {
+    for (auto &[key, batch] : batches) {
+        UnloadMesh(batch.mesh);
+    }
+
+    RL_FREE(opaqueMaterial.maps);
+    RL_FREE(alphaMaterial.maps);
+    RL_FREE(animatedOpaqueMaterial.maps);
+    RL_FREE(animatedAlphaMaterial.maps);
+}
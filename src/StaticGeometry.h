@@ -0,0 +1,115 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef STATICGEOMETRY_H
+#define STATICGEOMETRY_H
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include <raylib-cpp.hpp>
+
+#include "Map.h"
+#include "CelAtlas.h"
+#include "Culling.h"
+
+class Entity;
+class World;
+
+class StaticGeometry {
+    // atlas page, opaque, animated, chunk x, chunk y
+    typedef std::tuple<unsigned int, bool, bool, uint16_t, uint16_t> BatchKey;
+
+    struct Quad {
+        size_t segment;
+        const CelHandle *cel;
+        bool visible;
+        CelAnimation animation;
+    };
+
+    struct Batch {
+        raylib::TextureUnmanaged texture;
+        bool opaque;
+        bool animated;
+        raylib::Vector2 centre;
+        BoundingBox bounds;
+        bool potentiallyVisible;
+        std::vector<Quad> quads;
+        Mesh mesh;
+    };
+
+    struct DynamicWall {
+        Entity *entity;
+        uint16_t current;
+        std::vector<BatchKey> keys;
+        std::vector<size_t> slots;
+    };
+
+    // one shot animations get their start frame from the entity, it is patched into the quad when it changes
+    struct OneShotWall {
+        Entity *entity;
+        BatchKey key;
+        size_t slot;
+    };
+
+    std::map<BatchKey, Batch> batches;
+    std::vector<DynamicWall> dynamicWalls;
+    std::vector<OneShotWall> oneShotWalls;
+    std::vector<Segment> segments;
+    const uint64_t *potentiallyVisible = nullptr;
+    int frameCounter = 0;
+
+    Material opaqueMaterial;
+    Material alphaMaterial;
+
+    // animated batches pick the frame in the vertex shader from frameCounter
+    Material animatedOpaqueMaterial;
+    Material animatedAlphaMaterial;
+    int animatedOpaqueFrameLocation;
+    int animatedAlphaFrameLocation;
+
+    BatchKey getBatchKey(const Segment &segment, const CelHandle *cel, bool animated) const;
+    const Material &getMaterial(const Batch &batch) const;
+    void writeQuad(Batch &batch, size_t quad, bool upload);
+    void writeAnimation(Batch &batch, size_t quad, bool upload);
+public:
+    static const int ChunkSize = 160;
+
+    StaticGeometry(const Map &map, World *world);
+
+    StaticGeometry(const StaticGeometry &) = delete;
+    StaticGeometry &operator=(const StaticGeometry &) = delete;
+
+    size_t getBatchCount() const {
+        return batches.size();
+    }
+
+    // patches changed wall textures, applies the VisibilitySet row for the camera cell and advances animations
+    void update(const uint64_t *potentially_visible, uint64_t frame_count);
+
+    // both return the number of chunks that survived culling
+    size_t drawOpaque(const raylib::Camera3D *camera, const Frustum &frustum) const;
+    size_t drawAlphaTested(const Frustum &frustum) const;
+
+    ~StaticGeometry();
+};
+
+#endif //STATICGEOMETRY_H
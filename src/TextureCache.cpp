@@ -16,6 +16,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 ******************************************************************************/
 
+#include <algorithm>
 #include <unordered_map>
 #include <iostream>
 
@@ -24,19 +25,26 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "TextureCache.h"
 
 static std::unordered_map<std::string, raylib::TextureUnmanaged> cache;
+static std::unordered_map<std::string, CelHandle> cel_cache;
+static std::unordered_map<std::string, std::vector<CelHandle>> animation_cache;
+static CelAtlas cel_atlas;
 
-const raylib::TextureUnmanaged &TextureCache::LoadCelThree(const std::string &filename) {
+static const Palette &cel_palette() {
     static Palette palette("cels3/palette.pal");
+    return palette;
+}
 
-    if (cache.contains(filename)) {
-        return cache[filename];
-    }
+const CelHandle &TextureCache::LoadCelThree(const std::string &filename) {
+    const auto &palette = cel_palette();
 
-    raylib::TextureUnmanaged texture = CelThree(filename, palette).getTexture();
+    if (cel_cache.contains(filename)) {
+        return cel_cache.at(filename);
+    }
 
-    cache.emplace(filename, texture);
+    CelThree cel(filename, palette);
+    CelHandle handle = cel_atlas.add(cel.getImage(), cel.isOpaque());
 
-    return cache[filename];
+    return cel_cache.emplace(filename, handle).first->second;
 }
 
 const raylib::TextureUnmanaged &TextureCache::LoadStillCel(const std::string &filename) {
@@ -50,8 +58,8 @@ const raylib::TextureUnmanaged &TextureCache::LoadStillCel(const std::string &fi
     return cache[filename];
 }
 
-const std::vector<raylib::TextureUnmanaged> TextureCache::LoadCelThree(const std::vector<std::string> &filenames) {
-    std::vector<raylib::TextureUnmanaged> textures;
+const std::vector<CelHandle> TextureCache::LoadCelThree(const std::vector<std::string> &filenames) {
+    std::vector<CelHandle> textures;
 
     for (const auto &filename : filenames) {
         textures.push_back(TextureCache::LoadCelThree(filename));
@@ -60,6 +68,38 @@ const std::vector<raylib::TextureUnmanaged> TextureCache::LoadCelThree(const std
     return textures;
 }
 
+const std::vector<CelHandle> TextureCache::LoadCelAnimation(const std::vector<std::string> &filenames) {
+    std::string key;
+
+    for (const auto &filename : filenames) {
+        key += filename + ";";
+    }
+
+    if (animation_cache.contains(key)) {
+        return animation_cache.at(key);
+    }
+
+    // frames are added fresh even if cached on their own, a cached cel could sit anywhere in the atlas
+    std::vector<CelHandle> textures;
+    cel_atlas.reserveRun(filenames.size());
+
+    for (const auto &filename : filenames) {
+        CelThree cel(filename, cel_palette());
+        textures.push_back(cel_atlas.add(cel.getImage(), cel.isOpaque()));
+    }
+
+    // one batch draws every frame, so the animation is only opaque if all of them are
+    bool opaque = std::all_of(std::begin(textures), std::end(textures), [](const auto &texture) {
+        return texture.opaque;
+    });
+
+    for (auto &texture : textures) {
+        texture.opaque = opaque;
+    }
+
+    return animation_cache.emplace(key, textures).first->second;
+}
+
 const std::vector<raylib::TextureUnmanaged> TextureCache::LoadStillCel(const std::vector<std::string> &filenames) {
     std::vector<raylib::TextureUnmanaged> textures;
 
@@ -69,3 +109,7 @@ const std::vector<raylib::TextureUnmanaged> TextureCache::LoadStillCel(const std
 
     return textures;
 }
+
+const CelAtlas &TextureCache::GetCelAtlas() {
+    return cel_atlas;
+}
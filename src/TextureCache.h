@@ -24,12 +24,19 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include <raylib-cpp.hpp>
 
+#include "CelAtlas.h"
+
 class TextureCache {
 public:
-    static const raylib::TextureUnmanaged &LoadCelThree(const std::string &filename);
+    static const CelHandle &LoadCelThree(const std::string &filename);
     static const raylib::TextureUnmanaged &LoadStillCel(const std::string &filename);
-    static const std::vector<raylib::TextureUnmanaged> LoadCelThree(const std::vector<std::string> &filenames);
+    static const std::vector<CelHandle> LoadCelThree(const std::vector<std::string> &filenames);
     static const std::vector<raylib::TextureUnmanaged> LoadStillCel(const std::vector<std::string> &filenames);
+
+    // frames in consecutive atlas slots so shaders can step through them, see CelAnimation
+    static const std::vector<CelHandle> LoadCelAnimation(const std::vector<std::string> &filenames);
+
+    static const CelAtlas &GetCelAtlas();
 };
 
 #endif //TEXTURECACHE_H
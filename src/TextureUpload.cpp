@@ -0,0 +1,296 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "TextureUpload.h"
+#include "GLExtensions.h"
+
+struct Job {
+    TextureUpload::Decoder decode;
+    std::shared_ptr<TextureUpload::State> state;
+};
+
+struct Decoded {
+    std::shared_ptr<TextureUpload::State> state;
+    std::vector<raylib::Image> images;
+
+    // upload progress, images before image are done, rows before row of image are done
+    size_t image;
+    int row;
+};
+
+struct Copy {
+    unsigned int texture;
+    int y;
+    int width;
+    int rows;
+    size_t offset;
+};
+
+class Worker {
+public:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::deque<Decoded> decoded;
+    bool stop = false;
+
+    // last, so everything above exists before the thread starts
+    std::thread thread;
+
+    Worker() : thread([this]() { run(); }) {
+    }
+
+    void run() {
+        std::unique_lock lock(mutex);
+
+        while (true) {
+            wake.wait(lock, [this]() { return stop || !jobs.empty(); });
+
+            if (stop)
+                return;
+
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+
+            lock.unlock();
+
+            std::vector<raylib::Image> images;
+
+            try {
+                images = job.decode();
+            } catch (const std::exception &e) {
+                // the handle still resolves, just with nothing in it
+                std::cerr << "Texture decode failed: " << e.what() << std::endl;
+                images.clear();
+            }
+
+            for (auto &image : images) {
+                if (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+                    image.Format(PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+            }
+
+            lock.lock();
+            decoded.push_back(Decoded(job.state, std::move(images), 0, 0));
+        }
+    }
+
+    ~Worker() {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+
+        wake.notify_one();
+        thread.join();
+    }
+};
+
+// a ring of Regions slices when persistently mapped, else one slice orphaned every frame
+struct Stream {
+    unsigned int buffer = 0;
+    uint8_t *mapped = nullptr;
+    std::array<void *, TextureUpload::Regions> fences = {};
+    uint64_t frame = 0;
+};
+
+static bool worker_started = false;
+static std::deque<Decoded> uploading;
+static Stream stream;
+
+static Worker &worker() {
+    static Worker worker;
+    worker_started = true;
+    return worker;
+}
+
+static void open_stream() {
+    const size_t size = TextureUpload::RegionSize * TextureUpload::Regions;
+    const unsigned int flags = gl_map_write_bit | gl_map_persistent_bit | gl_map_coherent_bit;
+
+    glad_glGenBuffers(1, &stream.buffer);
+    glad_glBindBuffer(gl_pixel_unpack_buffer, stream.buffer);
+
+    if (glad_glBufferStorage) {
+        glad_glBufferStorage(gl_pixel_unpack_buffer, size, nullptr, flags);
+        stream.mapped = (uint8_t *)glad_glMapBufferRange(gl_pixel_unpack_buffer, 0, size, flags);
+    }
+
+    if (!stream.mapped)
+        glad_glBufferData(gl_pixel_unpack_buffer, TextureUpload::RegionSize, nullptr, gl_stream_draw);
+
+    glad_glBindBuffer(gl_pixel_unpack_buffer, 0);
+}
+
+TextureUpload::State::~State() {
+    // statics released after the window closed have no context left to unload from
+    if (!IsWindowReady())
+        return;
+
+    for (auto &texture : textures)
+        texture.Unload();
+}
+
+const raylib::TextureUnmanaged &TextureUpload::Handle::get(size_t index) const {
+    // created on first use, after the window has a GL context
+    static const raylib::Image blank(raylib::Image::Color(1, 1, BLANK));
+    static const raylib::TextureUnmanaged placeholder(blank);
+
+    if (!isReady() || index >= state->textures.size())
+        return placeholder;
+
+    return state->textures[index];
+}
+
+TextureUpload::Handle TextureUpload::Load(const Decoder &decode) {
+    auto state = std::make_shared<State>();
+
+    {
+        auto &queue = worker();
+        std::lock_guard lock(queue.mutex);
+        queue.jobs.push_back(Job(decode, state));
+    }
+
+    worker().wake.notify_one();
+
+    return Handle(state);
+}
+
+void TextureUpload::Update() {
+    if (!worker_started)
+        return;
+
+    {
+        auto &queue = worker();
+        std::lock_guard lock(queue.mutex);
+
+        while (!queue.decoded.empty()) {
+            uploading.push_back(std::move(queue.decoded.front()));
+            queue.decoded.pop_front();
+
+            // the texture storage is allocated up front, only the pixels are streamed
+            auto &item = uploading.back();
+
+            for (const auto &image : item.images) {
+                unsigned int id = rlLoadTexture(nullptr, image.width, image.height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+                item.state->textures.push_back(raylib::TextureUnmanaged(id, image.width, image.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8));
+            }
+        }
+    }
+
+    // nobody holds a handle any more, so stop streaming and let the state unload what was allocated
+    std::erase_if(uploading, [](const Decoded &item) { return item.state.use_count() == 1; });
+
+    if (!uploading.empty()) {
+        if (!stream.buffer)
+            open_stream();
+
+        size_t region = stream.frame % Regions;
+
+        // still being read by the GPU from Regions frames ago, skip a frame rather than stall
+        if (stream.fences[region]) {
+            if (glad_glClientWaitSync(stream.fences[region], 0, 0) == gl_timeout_expired)
+                return;
+
+            glad_glDeleteSync(stream.fences[region]);
+            stream.fences[region] = nullptr;
+        }
+
+        stream.frame++;
+
+        glad_glBindBuffer(gl_pixel_unpack_buffer, stream.buffer);
+
+        size_t base = 0;
+        uint8_t *target = nullptr;
+
+        if (stream.mapped) {
+            base = region * RegionSize;
+            target = stream.mapped + base;
+        } else {
+            target = (uint8_t *)glad_glMapBufferRange(gl_pixel_unpack_buffer, 0, RegionSize, gl_map_write_bit | gl_map_invalidate_buffer_bit);
+        }
+
+        std::vector<Copy> copies;
+        size_t used = 0;
+        bool full = !target;
+
+        for (auto &item : uploading) {
+            while (!full && item.image < item.images.size()) {
+                const auto &image = item.images[item.image];
+                const size_t row_bytes = image.width * 4;
+
+                int rows = std::min((size_t)(image.height - item.row), (RegionSize - used) / row_bytes);
+
+                if (rows == 0) {
+                    full = true;
+                    break;
+                }
+
+                std::memcpy(target + used, (const uint8_t *)image.data + item.row * row_bytes, rows * row_bytes);
+                copies.push_back(Copy(item.state->textures[item.image].id, item.row, image.width, rows, base + used));
+
+                used += rows * row_bytes;
+                item.row += rows;
+
+                if (item.row == image.height) {
+                    item.image++;
+                    item.row = 0;
+                }
+            }
+        }
+
+        if (!stream.mapped && target)
+            glad_glUnmapBuffer(gl_pixel_unpack_buffer);
+
+        // with a buffer bound the pixel pointer is an offset into it
+        for (const auto &copy : copies) {
+            glad_glBindTexture(gl_texture_2d, copy.texture);
+            glad_glTexSubImage2D(gl_texture_2d, 0, 0, copy.y, copy.width, copy.rows, gl_rgba, gl_unsigned_byte, (const void *)copy.offset);
+        }
+
+        if (stream.mapped)
+            stream.fences[region] = glad_glFenceSync(gl_sync_gpu_commands_complete, 0);
+
+        glad_glBindTexture(gl_texture_2d, 0);
+        glad_glBindBuffer(gl_pixel_unpack_buffer, 0);
+    }
+
+    // everything is copied in queue order, so finished uploads are always at the front
+    while (!uploading.empty() && uploading.front().image == uploading.front().images.size()) {
+        uploading.front().state->ready = true;
+        uploading.pop_front();
+    }
+}
+
+size_t TextureUpload::GetPending() {
+    if (!worker_started)
+        return 0;
+
+    auto &queue = worker();
+    std::lock_guard lock(queue.mutex);
+
+    return queue.jobs.size() + queue.decoded.size() + uploading.size();
+}
@@ -0,0 +1,81 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+#ifndef TEXTUREUPLOAD_H
+#define TEXTUREUPLOAD_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+// Decodes images on a worker thread and streams them to the GPU through pixel buffers, a slice each frame
+class TextureUpload {
+public:
+    // shared by the Handles and the upload queue, main thread only
+    struct State {
+        bool ready = false;
+        std::vector<raylib::TextureUnmanaged> textures;
+
+        // the last reference is always dropped on the main thread
+        ~State();
+    };
+
+    static const size_t RegionSize = 1024 * 1024;
+    static const int Regions = 3;
+
+    class Handle {
+        std::shared_ptr<State> state;
+    public:
+        Handle() {
+        }
+
+        Handle(const std::shared_ptr<State> &state) : state(state) {
+        }
+
+        bool isLoaded() const {
+            return state != nullptr;
+        }
+
+        bool isReady() const {
+            return state && state->ready;
+        }
+
+        // 0 until ready
+        size_t getCount() const {
+            return isReady() ? state->textures.size() : 0;
+        }
+
+        // a blank placeholder until ready
+        const raylib::TextureUnmanaged &get(size_t index = 0) const;
+    };
+
+    // runs on the worker, so it must not touch GL
+    typedef std::function<std::vector<raylib::Image>()> Decoder;
+
+    static Handle Load(const Decoder &decode);
+
+    // main thread, once a frame, copies at most RegionSize bytes and never waits on the GPU
+    static void Update();
+
+    // images decoded or still to decode that have not finished uploading
+    static size_t GetPending();
+};
+
+#endif //TEXTUREUPLOAD_H
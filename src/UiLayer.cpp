@@ -0,0 +1,65 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+#include "UiLayer.h"
+
+void UiLayer::update(uint32_t new_revision, int new_scale, const std::function<void()> &render) {
+    if (!dirty && layer && revision == new_revision && scale == new_scale)
+        return;
+
+    int width = area.width * new_scale;
+    int height = area.height * new_scale;
+
+    if (layer && (layer->texture.width != width || layer->texture.height != height)) {
+        UnloadRenderTexture(*layer);
+        layer = std::nullopt;
+    }
+
+    if (!layer)
+        layer = LoadRenderTexture(width, height);
+
+    BeginTextureMode(*layer);
+    {
+        ClearBackground(BLANK);
+
+        rlPushMatrix();
+        rlTranslatef(-area.x * new_scale, -area.y * new_scale, 0.0f);
+        render();
+        rlPopMatrix();
+    }
+    EndTextureMode();
+
+    revision = new_revision;
+    scale = new_scale;
+    dirty = false;
+}
+
+void UiLayer::draw() const {
+    if (!layer)
+        return;
+
+    float width = layer->texture.width;
+    float height = layer->texture.height;
+
+    // render textures are stored upside down
+    DrawTextureRec(layer->texture, raylib::Rectangle(0.0f, 0.0f, width, -height), Vector2(area.x * scale, area.y * scale), WHITE);
+}
+
+UiLayer::~UiLayer() {
+    if (layer)
+        UnloadRenderTexture(*layer);
+}
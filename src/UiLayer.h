@@ -0,0 +1,56 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+#ifndef UILAYER_H
+#define UILAYER_H
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include <raylib-cpp.hpp>
+
+// Static part of a screen kept in a texture and only redrawn when its revision, scale or dirty flag changes
+class UiLayer {
+    std::optional<RenderTexture2D> layer;
+
+    raylib::Rectangle area;
+    uint32_t revision = 0;
+    int scale = 0;
+    bool dirty = true;
+public:
+    // area in unscaled 320x200 screen units
+    UiLayer(const raylib::Rectangle &area) : area(area) {
+    }
+
+    UiLayer(const UiLayer &) = delete;
+    UiLayer &operator=(const UiLayer &) = delete;
+
+    void invalidate() {
+        dirty = true;
+    }
+
+    // renders into a texture, so call it before Screen::BeginFrame
+    // render draws in screen pixels, the layer offset is applied for it
+    void update(uint32_t revision, int scale, const std::function<void()> &render);
+
+    void draw() const;
+
+    ~UiLayer();
+};
+
+#endif //UILAYER_H
@@ -0,0 +1,415 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <sstream>
+
+#include "VisibilitySet.h"
+#include "Entity.h"
+#include "World.h"
+
+static const uint32_t cache_version = 2;
+static const char cache_magic[4] = {'P', 'V', 'S', char('0' + cache_version)};
+
+static const float sample_spacing = 10.0f;
+static const float billboard_offset = 3.5f;
+static const float cell_inset = 1.0f;
+
+struct Blocker {
+    raylib::Vector2 a;
+    raylib::Vector2 b;
+    uint32_t index;
+};
+
+// FNV-1a, the cache key has to come out the same from every compiler and standard library
+static uint64_t fnv1a(const std::string &data, uint64_t hash = 0xcbf29ce484222325ULL) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+// the data directory may be read only, so the cache lives with the user's other caches
+static std::optional<std::filesystem::path> cache_directory() {
+#ifdef _WIN64
+    const char *local_app_data = std::getenv("LOCALAPPDATA");
+
+    if (local_app_data && *local_app_data)
+        return std::filesystem::path(local_app_data) / "IsleOfTheDeadRemake" / "pvs";
+#else
+    const char *xdg_cache_home = std::getenv("XDG_CACHE_HOME");
+
+    if (xdg_cache_home && *xdg_cache_home)
+        return std::filesystem::path(xdg_cache_home) / "isleofthedead" / "pvs";
+
+    const char *home = std::getenv("HOME");
+
+    if (home && *home)
+        return std::filesystem::path(home) / ".cache" / "isleofthedead" / "pvs";
+#endif
+
+    return std::nullopt;
+}
+
+static float cross(const raylib::Vector2 &l, const raylib::Vector2 &r) {
+    return l.x * r.y - l.y * r.x;
+}
+
+// only proper crossings block, rays through wall ends or along a wall slip past
+static bool crosses(const raylib::Vector2 &p, const raylib::Vector2 &q, const Blocker &blocker) {
+    const float epsilon = 1e-4f;
+
+    raylib::Vector2 r = q - p;
+    raylib::Vector2 s = blocker.b - blocker.a;
+
+    float denominator = cross(r, s);
+
+    if (std::fabs(denominator) < epsilon)
+        return false;
+
+    raylib::Vector2 offset = blocker.a - p;
+
+    float t = cross(offset, s) / denominator;
+    float u = cross(offset, r) / denominator;
+
+    return t > epsilon && t < 1.0f - epsilon && u > epsilon && u < 1.0f - epsilon;
+}
+
+static std::pair<raylib::Vector2, raylib::Vector2> wall_line(const Segment &segment) {
+    // same collapse to an axis aligned line as the wall renderers
+    if (segment.y1 != segment.y2)
+        return std::make_pair(raylib::Vector2(segment.x1, segment.y1), raylib::Vector2(segment.x1, segment.y2));
+
+    return std::make_pair(raylib::Vector2(segment.x1, segment.y1), raylib::Vector2(segment.x2, segment.y1));
+}
+
+static std::vector<raylib::Vector2> sample_points(const Segment &segment) {
+    std::vector<raylib::Vector2> points;
+
+    if (segment.texture >= 100) {
+        raylib::Vector2 centre(segment.x1, segment.y1);
+
+        points.push_back(centre);
+        points.push_back(centre + raylib::Vector2(-billboard_offset, -billboard_offset));
+        points.push_back(centre + raylib::Vector2(billboard_offset, -billboard_offset));
+        points.push_back(centre + raylib::Vector2(billboard_offset, billboard_offset));
+        points.push_back(centre + raylib::Vector2(-billboard_offset, billboard_offset));
+
+        return points;
+    }
+
+    auto [a, b] = wall_line(segment);
+
+    float length = a.Distance(b);
+    int steps = std::max(1, (int)std::ceil(length / sample_spacing));
+
+    for (int i = 0; i <= steps; i++) {
+        points.push_back(a.Lerp(b, (float)i / steps));
+    }
+
+    return points;
+}
+
+std::future<std::unique_ptr<VisibilitySet>> VisibilitySet::Start(const Map &map, World *world) {
+    std::vector<bool> blocking(map.getSegments().size(), false);
+
+    for (const auto &segment : map.getSegments()) {
+        Entity *entity = world->getEntity(segment.id);
+
+        if (!entity)
+            continue;
+
+        auto textures = entity->getWallTextures();
+
+        // a wall only hides what is behind it if every texture it can show is opaque
+        blocking[segment.index] = !textures.empty() && std::all_of(std::begin(textures), std::end(textures), [](const auto *texture) {
+            return texture->opaque;
+        });
+    }
+
+    // the level owning the map waits on the future before the map goes
+    return std::async(std::launch::async, [&map, blocking = std::move(blocking)]() {
+        return std::make_unique<VisibilitySet>(map, blocking);
+    });
+}
+
+VisibilitySet::VisibilitySet(const Map &map, const std::vector<bool> &blocking) : width(map.getWidth() / CellSize + 1), height(map.getHeight() / CellSize + 1) {
+    const auto &segments = map.getSegments();
+
+    words = (segments.size() + 63) / 64;
+
+    std::string blocking_key;
+
+    for (bool block : blocking) {
+        blocking_key.push_back(block ? '1' : '0');
+    }
+
+    std::ifstream fh(map.getFilename(), std::ios::binary|std::ios::in);
+    std::string map_data((std::istreambuf_iterator<char>(fh)), std::istreambuf_iterator<char>());
+
+    uint64_t key = fnv1a(blocking_key, fnv1a(map_data));
+
+    auto directory_if = cache_directory();
+
+    std::stringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".pvs";
+
+    if (directory_if && load((*directory_if / name.str()).string()))
+        return;
+
+    build(segments, blocking);
+
+    if (directory_if)
+        save((*directory_if / name.str()).string());
+}
+
+void VisibilitySet::build(const std::vector<Segment> &segments, const std::vector<bool> &blocking) {
+    bits.assign(width * height * words, 0);
+
+    std::vector<Blocker> blockers;
+    std::vector<std::vector<uint32_t>> blocker_cells(width * height);
+
+    for (const auto &segment : segments) {
+        if (!blocking[segment.index])
+            continue;
+
+        auto [a, b] = wall_line(segment);
+
+        // walls sit on cell edges, so register them with the cells on both sides
+        int min_x = std::max(0, (int)(std::min(a.x, b.x) - cell_inset) / CellSize);
+        int max_x = std::min(width - 1, (int)(std::max(a.x, b.x) + cell_inset) / CellSize);
+        int min_y = std::max(0, (int)(std::min(a.y, b.y) - cell_inset) / CellSize);
+        int max_y = std::min(height - 1, (int)(std::max(a.y, b.y) + cell_inset) / CellSize);
+
+        for (int y = min_y; y <= max_y; y++) {
+            for (int x = min_x; x <= max_x; x++) {
+                blocker_cells[(y * width) + x].push_back(blockers.size());
+            }
+        }
+
+        blockers.push_back(Blocker(a, b, segment.index));
+    }
+
+    std::vector<uint32_t> stamps(blockers.size(), 0);
+    uint32_t stamp = 0;
+
+    auto is_blocked = [&](const raylib::Vector2 &p, const raylib::Vector2 &q, uint32_t target) {
+        stamp++;
+
+        int cell_x = std::floor(p.x / CellSize);
+        int cell_y = std::floor(p.y / CellSize);
+        int end_x = std::floor(q.x / CellSize);
+        int end_y = std::floor(q.y / CellSize);
+
+        raylib::Vector2 direction = q - p;
+
+        int step_x = direction.x > 0 ? 1 : -1;
+        int step_y = direction.y > 0 ? 1 : -1;
+
+        const float infinity = std::numeric_limits<float>::infinity();
+
+        float delta_x = direction.x != 0 ? CellSize / std::fabs(direction.x) : infinity;
+        float delta_y = direction.y != 0 ? CellSize / std::fabs(direction.y) : infinity;
+        float next_x = direction.x != 0 ? ((cell_x + (step_x > 0 ? 1 : 0)) * CellSize - p.x) / direction.x : infinity;
+        float next_y = direction.y != 0 ? ((cell_y + (step_y > 0 ? 1 : 0)) * CellSize - p.y) / direction.y : infinity;
+
+        while (true) {
+            if (cell_x >= 0 && cell_x < width && cell_y >= 0 && cell_y < height) {
+                for (auto blocker_index : blocker_cells[(cell_y * width) + cell_x]) {
+                    if (stamps[blocker_index] == stamp)
+                        continue;
+
+                    stamps[blocker_index] = stamp;
+
+                    const auto &blocker = blockers[blocker_index];
+
+                    if (blocker.index != target && crosses(p, q, blocker))
+                        return true;
+                }
+            }
+
+            if ((cell_x == end_x && cell_y == end_y) || std::min(next_x, next_y) > 1.0f)
+                return false;
+
+            if (next_x < next_y) {
+                next_x += delta_x;
+                cell_x += step_x;
+            } else {
+                next_y += delta_y;
+                cell_y += step_y;
+            }
+        }
+    };
+
+    std::vector<std::vector<raylib::Vector2>> targets;
+
+    for (const auto &segment : segments) {
+        targets.push_back(sample_points(segment));
+    }
+
+    for (uint16_t y = 0; y < height; y++) {
+        for (uint16_t x = 0; x < width; x++) {
+            // the camera can be anywhere inside the cell
+            const std::array<raylib::Vector2, 5> origins = {
+                raylib::Vector2((x + 0.5f) * CellSize, (y + 0.5f) * CellSize),
+                raylib::Vector2(x * CellSize + cell_inset, y * CellSize + cell_inset),
+                raylib::Vector2((x + 1) * CellSize - cell_inset, y * CellSize + cell_inset),
+                raylib::Vector2((x + 1) * CellSize - cell_inset, (y + 1) * CellSize - cell_inset),
+                raylib::Vector2(x * CellSize + cell_inset, (y + 1) * CellSize - cell_inset),
+            };
+
+            uint64_t *row = bits.data() + (((y * width) + x) * words);
+
+            for (size_t i = 0; i < segments.size(); i++) {
+                uint32_t index = segments[i].index;
+
+                bool visible = std::any_of(std::begin(targets[i]), std::end(targets[i]), [&](const auto &target) {
+                    return std::any_of(std::begin(origins), std::end(origins), [&](const auto &origin) {
+                        return !is_blocked(origin, target, index);
+                    });
+                });
+
+                if (visible)
+                    row[index / 64] |= (1ULL << (index % 64));
+            }
+        }
+    }
+
+    // The rays only sample the cell and the segments, so a wall seen between samples would be missed. Each cell
+    // also takes whatever its neighbours see, which covers sight lines that only open up near its edges.
+    std::vector<uint64_t> sampled = bits;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint64_t *row = bits.data() + (((y * width) + x) * words);
+
+            for (int neighbour_y = std::max(0, y - 1); neighbour_y <= std::min(height - 1, y + 1); neighbour_y++) {
+                for (int neighbour_x = std::max(0, x - 1); neighbour_x <= std::min(width - 1, x + 1); neighbour_x++) {
+                    const uint64_t *neighbour = sampled.data() + (((neighbour_y * width) + neighbour_x) * words);
+
+                    for (size_t word = 0; word < words; word++) {
+                        row[word] |= neighbour[word];
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool VisibilitySet::load(const std::string &filename) {
+    std::ifstream fh(filename, std::ios::binary|std::ios::in);
+
+    if (!fh)
+        return false;
+
+    char magic[4];
+    uint16_t cached_width;
+    uint16_t cached_height;
+    uint32_t cached_words;
+
+    fh.read(magic, sizeof(magic));
+    fh.read((char *)&cached_width, sizeof(cached_width));
+    fh.read((char *)&cached_height, sizeof(cached_height));
+    fh.read((char *)&cached_words, sizeof(cached_words));
+
+    if (!fh || !std::equal(std::begin(magic), std::end(magic), std::begin(cache_magic)))
+        return false;
+
+    if (cached_width != width || cached_height != height || cached_words != words)
+        return false;
+
+    bits.clear();
+    bits.reserve(width * height * words);
+
+    // runs of repeated words, most of a row is zero
+    while (bits.size() < width * height * words) {
+        uint32_t run;
+        uint64_t word;
+
+        fh.read((char *)&run, sizeof(run));
+        fh.read((char *)&word, sizeof(word));
+
+        if (!fh || run == 0 || bits.size() + run > width * height * words)
+            return false;
+
+        bits.insert(std::end(bits), run, word);
+    }
+
+    return true;
+}
+
+void VisibilitySet::save(const std::string &filename) const {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(filename).parent_path(), error);
+
+    // the cache is only an optimisation, if it cannot be written the set is just rebuilt next time
+    std::ofstream fh(filename, std::ios::binary|std::ios::out);
+
+    if (!fh)
+        return;
+
+    uint16_t cached_width = width;
+    uint16_t cached_height = height;
+    uint32_t cached_words = words;
+
+    fh.write(cache_magic, sizeof(cache_magic));
+    fh.write((const char *)&cached_width, sizeof(cached_width));
+    fh.write((const char *)&cached_height, sizeof(cached_height));
+    fh.write((const char *)&cached_words, sizeof(cached_words));
+
+    for (size_t i = 0; i < bits.size();) {
+        uint32_t run = 1;
+
+        while (i + run < bits.size() && bits[i + run] == bits[i]) {
+            run++;
+        }
+
+        fh.write((const char *)&run, sizeof(run));
+        fh.write((const char *)&bits[i], sizeof(bits[i]));
+
+        i += run;
+    }
+}
+
+const uint64_t *VisibilitySet::getRow(const raylib::Vector3 &position) const {
+    if (position.x < 0 || position.z < 0)
+        return nullptr;
+
+    size_t x = position.x / CellSize;
+    size_t y = position.z / CellSize;
+
+    if (x >= width || y >= height)
+        return nullptr;
+
+    return bits.data() + (((y * width) + x) * words);
+}
+
+VisibilitySet::~VisibilitySet() {
+
+}
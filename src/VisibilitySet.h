@@ -0,0 +1,64 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef VISIBILITYSET_H
+#define VISIBILITYSET_H
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+#include "Map.h"
+
+class World;
+
+// Precomputed potentially visible set, one bit per segment for every grid cell
+class VisibilitySet {
+    uint16_t width;
+    uint16_t height;
+    size_t words;
+    std::vector<uint64_t> bits;
+
+    void build(const std::vector<Segment> &segments, const std::vector<bool> &blocking);
+
+    bool load(const std::string &filename);
+    void save(const std::string &filename) const;
+public:
+    static const int CellSize = 10;
+
+    // loads the cached set or runs the rays, slow enough to keep off the main thread
+    VisibilitySet(const Map &map, const std::vector<bool> &blocking);
+
+    // asks the entities which walls block on the calling thread, then loads or builds on a worker
+    static std::future<std::unique_ptr<VisibilitySet>> Start(const Map &map, World *world);
+
+    // bits for the cell holding the position, nullptr outside the map
+    const uint64_t *getRow(const raylib::Vector3 &position) const;
+
+    static bool Test(const uint64_t *row, uint32_t index) {
+        return row[index / 64] & (1ULL << (index % 64));
+    }
+
+    ~VisibilitySet();
+};
+
+#endif //VISIBILITYSET_H
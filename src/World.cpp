@@ -33,7 +33,7 @@ World::World(MusicPlayer *music_player, const std::vector<LevelSettings> &level_
     entrances = Entrance::Parse(entrance_filename); 
 
     for (const auto &level_settings : level_settings_list) {
-        auto level_data = levels.emplace(level_settings.filename, Level(level_settings));
+        auto level_data = levels.try_emplace(level_settings.filename, level_settings);
 
         //std::cout << level_settings.filename << "\n";
 
@@ -42,6 +42,8 @@ World::World(MusicPlayer *music_player, const std::vector<LevelSettings> &level_
             for (const auto &segment : level->second.getMap()->getSegments()) {
                 spawnEntityForSegment(level_settings.filename, segment);
             }
+
+            level->second.bake(this);
         }
     }
 
@@ -52,14 +54,14 @@ void World::spawnPassage(const Segment &segment) {
     static const auto tree_closed_entry = TextureCache::LoadCelThree("cels3/rent1.cel");
     static const auto tree_opened_entry = TextureCache::LoadCelThree("cels3/jtocave.cel");
 
-    static const auto big_door_anim = TextureCache::LoadCelThree({
+    static const auto big_door_anim = TextureCache::LoadCelAnimation({
         "cels3/bigdoor1.cel",
         "cels3/bigdoor2.cel",
         "cels3/bigdoor3.cel",
         "cels3/bigdoor4.cel",
     });
 
-    static const auto temple_door_anim = TextureCache::LoadCelThree({
+    static const auto temple_door_anim = TextureCache::LoadCelAnimation({
         "cels3/tmpdoor1.cel",
         "cels3/tmpdoor2.cel",
         "cels3/tmpdoor3.cel",
@@ -71,7 +73,7 @@ void World::spawnPassage(const Segment &segment) {
     static const auto unknown = TextureCache::LoadCelThree("cels3/unknown.cel");
 
     static const auto boogate = TextureCache::LoadCelThree("cels3/boogate.cel");
-    static const auto hut_door_anim = TextureCache::LoadCelThree({
+    static const auto hut_door_anim = TextureCache::LoadCelAnimation({
         "cels3/hutdoor1.cel",
         "cels3/hutdoor2.cel",
         "cels3/hutdoor3.cel",
@@ -529,7 +531,7 @@ void World::spawnPassage(const Segment &segment) {
 }
 
 void World::spawnEntityForSegment(const std::string &map_filename, const Segment &segment) {
-    static const auto beach = TextureCache::LoadCelThree({
+    static const auto beach = TextureCache::LoadCelAnimation({
         "cels3/beach1.cel",
         "cels3/beach2.cel",
         "cels3/beach3.cel",
@@ -588,13 +590,13 @@ void World::spawnEntityForSegment(const std::string &map_filename, const Segment
     static const auto runway = TextureCache::LoadCelThree("cels3/runway.cel");
 
     // Damageable/animated walls
-    static const auto fireplace_left = TextureCache::LoadCelThree({
+    static const auto fireplace_left = TextureCache::LoadCelAnimation({
         "cels3/firepl1a.cel",
         "cels3/firepl1b.cel",
         "cels3/firepl1c.cel",
     });
 
-    static const auto fireplace_right = TextureCache::LoadCelThree({
+    static const auto fireplace_right = TextureCache::LoadCelAnimation({
         "cels3/firepl2a.cel",
         "cels3/firepl2b.cel",
         "cels3/firepl2c.cel",
@@ -622,19 +624,19 @@ void World::spawnEntityForSegment(const std::string &map_filename, const Segment
     });
 */
 
-    static const auto plane_fire_left = TextureCache::LoadCelThree({
+    static const auto plane_fire_left = TextureCache::LoadCelAnimation({
         "cels3/fire1a.cel",
         "cels3/fire2a.cel",
         "cels3/fire3a.cel",
     });
 
-    static const auto plane_fire_mid = TextureCache::LoadCelThree({
+    static const auto plane_fire_mid = TextureCache::LoadCelAnimation({
         "cels3/fire1b.cel",
         "cels3/fire2b.cel",
         "cels3/fire3b.cel",
     });
 
-    static const auto plane_fire_right = TextureCache::LoadCelThree({
+    static const auto plane_fire_right = TextureCache::LoadCelAnimation({
         "cels3/fire1c.cel",
         "cels3/fire2c.cel",
         "cels3/fire3c.cel",
@@ -667,7 +669,7 @@ void World::spawnEntityForSegment(const std::string &map_filename, const Segment
     static const auto labtable = TextureCache::LoadCelThree("cels3/labtable.cel");
     static const auto table = TextureCache::LoadCelThree("cels3/table.cel");
     static const auto vine = TextureCache::LoadCelThree("cels3/vine.cel");
-    static const auto tiki = TextureCache::LoadCelThree({
+    static const auto tiki = TextureCache::LoadCelAnimation({
         "cels3/tiki1.cel",
         "cels3/tiki2.cel",
         "cels3/tiki3.cel",
@@ -1167,10 +1169,10 @@ void World::spawnEntityForSegment(const std::string &map_filename, const Segment
         "cels3/hngar05.cel",
     });
 
-    static const auto camp_gate = TextureCache::LoadCelThree(std::vector<std::string>({
+    static const auto camp_gate = TextureCache::LoadCelAnimation({
         "cels3/cmpgate1.cel",
         "cels3/cmpgate2.cel"
-        }));
+    });
     static const auto unknown = TextureCache::LoadCelThree("cels3/unknown.cel");
 
     static const auto missile_left = TextureCache::LoadCelThree("cels3/misslec1.cel");
@@ -32,6 +32,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Entrance.h"
 #include "Entity.h"
 #include "MusicPlayer.h"
+#include "Automap.h"
 
 class World {
     std::unordered_map<std::string, Level> levels;
@@ -45,6 +46,10 @@ class World {
 
     std::unordered_map<uint64_t, std::unique_ptr<Entity>> entities;
     MusicPlayer *musicPlayer;
+    Automap automap;
+
+    // culling and batching counters over the 3D view
+    bool showStats = false;
 public:
     World(MusicPlayer *music_player, const std::vector<LevelSettings> &level_settings, const std::string &entrance_filename); 
 
@@ -52,6 +57,10 @@ public:
         return musicPlayer;
     }
 
+    Automap &getAutomap() {
+        return automap;
+    }
+
     Level *getCurrentLevel() {
         return &levels.at(currentMap);
     }
@@ -63,6 +72,26 @@ public:
         return &levels.at(map_name);
     }
 
+    void setDrawDistance(float draw_distance) {
+        for (auto &[filename, level] : levels) {
+            level.setDrawDistance(draw_distance);
+        }
+    }
+
+    bool getShowStats() const {
+        return showStats;
+    }
+
+    void setShowStats(bool show_stats) {
+        showStats = show_stats;
+    }
+
+    void setSoftwareRendering(bool enabled) {
+        for (auto &[filename, level] : levels) {
+            level.setSoftwareRendering(enabled);
+        }
+    }
+
     Entity *getEntity(uint64_t id) {
         try {
             return entities.at(id).get();
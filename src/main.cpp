@@ -26,9 +26,12 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <vector>
 #include <iomanip>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 #include <filesystem>
 #include <chrono>
 #include <thread>
+#include <iostream>
 
 #include <cmdline.h>
 #include <raylib-cpp.hpp>
@@ -48,6 +51,10 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Help.h"
 #include "SoundCache.h"
 #include "TextureCache.h"
+#include "TextureUpload.h"
+#include "Screen.h"
+#include "DynamicResolution.h"
+#include "Capture.h"
 
 static void draw_world(Player *player, MusicPlayer *music_player, raylib::Window &window, const int scale) {
     static uint64_t frame_count = 0;
@@ -57,7 +64,6 @@ static void draw_world(Player *player, MusicPlayer *music_player, raylib::Window
 
     auto *world = player->getWorld();
     auto *level = world->getCurrentLevel();
-    auto *map = level->getMap();
 
     if (player->testFlag(Flag::BombCountdown)) {
         if (countdown) {
@@ -75,13 +81,7 @@ static void draw_world(Player *player, MusicPlayer *music_player, raylib::Window
 
     player->update(frame_count);
 
-    for (const auto &segment : map->getSegments()) {
-        Entity *entity = world->getEntity(segment.id);
-
-        if (entity) {
-            entity->update(player, frame_count);
-        }
-    }
+    level->update(player, frame_count);
 
     level->draw(player, window, frame_count, scale);
 } 
@@ -110,140 +110,81 @@ static void draw_map(Player *player, raylib::Window &window, const int scale) {
     auto player_angles = player->getAngles();
     auto player_position_angled = (raylib::Vector2(0, -10).Rotate(DEG2RAD * player_angles.GetX())) + player_position;
 
-    BeginDrawing();
+    // segments only change with the level, so they come from the cached layer
+    auto &automap = world->getAutomap();
+    automap.update(world, map, scale);
+
+    Screen::BeginFrame();
     {
         window.ClearBackground(raylib::BLACK);
 
         Fnt::Write(map->getFilename(), 800, 8, scale);
 
+        // the layer has one line width of margin around the map
+        automap.draw(raylib::Rectangle(scale * 9.0f, scale * 9.0f, automap.getWidth(), automap.getHeight()));
+
         camera.BeginMode();
         {
-            for (const auto &segment : map->getSegments()) {
-                Entity *entity = world->getEntity(segment.id);
-
-                if (entity) {
-                    switch (entity->getType()) {
-                        case SegmentType::Unknown:
-                            DrawLineEx(raylib::Vector2(segment.x1, segment.y1) * 0.4 * scale, raylib::Vector2(segment.x2, segment.y2) * 0.4 * scale, scale, raylib::GRAY);
-                            break;
-                        case SegmentType::Wall:
-                            DrawLineEx(raylib::Vector2(segment.x1, segment.y1) * 0.4 * scale, raylib::Vector2(segment.x2, segment.y2) * 0.4 * scale, scale, raylib::YELLOW);
-                            break;
-                        case SegmentType::Door:
-                            DrawLineEx(raylib::Vector2(segment.x1, segment.y1) * 0.4 * scale, raylib::Vector2(segment.x2, segment.y2) * 0.4 * scale, scale, raylib::BLUE);
-                            break;
-                        case SegmentType::Monster:
-                            DrawLineEx(raylib::Vector2(segment.x1, segment.y1) * 0.4 * scale, raylib::Vector2(segment.x2, segment.y2) * 0.4 * scale, scale, raylib::RED);
-                            break;
-                        case SegmentType::Item:
-                            DrawLineEx(raylib::Vector2(segment.x1, segment.y1) * 0.4 * scale, raylib::Vector2(segment.x2, segment.y2) * 0.4 * scale, scale, raylib::WHITE);
-                            break;
-                        case SegmentType::Prop:
-                            DrawLineEx(raylib::Vector2(segment.x1, segment.y1) * 0.4 * scale, raylib::Vector2(segment.x2, segment.y2) * 0.4 * scale, scale, raylib::GREEN);
-                            break;
-                        case SegmentType::Trap:
-                            DrawLineEx(raylib::Vector2(segment.x1, segment.y1) * 0.4 * scale, raylib::Vector2(segment.x2, segment.y2) * 0.4 * scale, scale, raylib::PURPLE);
-                            break;
-                    }
-                }
-            }
-
             if (player->getItemCount(Item::Compass)) {
-                DrawLineEx(player_position * 0.4 * scale, player_position_angled * 0.4 * scale, scale, raylib::BLUE);
-                DrawCircleV(player_position * 0.4 * scale, 0.4 * scale * 3, raylib::BLUE);
+                DrawLineEx(player_position * Automap::MapScale * scale, player_position_angled * Automap::MapScale * scale, scale, raylib::BLUE);
+                DrawCircleV(player_position * Automap::MapScale * scale, Automap::MapScale * scale * 3, raylib::BLUE);
             }
         }
         camera.EndMode();
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
-static void play_death_anim(Player *player, raylib::Window &window, const int scale) {
-    DeathType death_type = player->getDeathType();
-
-    static auto acid_anim = Animation("fli/acid.fli");
-    static auto bat_anim = Animation("fli/batkill.fli");
-    static auto bomb_anim = Animation("fli/isle.fli");
-    static auto companion_anim = Animation("fli/zombabe.fli");
-    static auto doc_anim = Animation("fli/memkill.fli");
-    static auto fence_anim = Animation("fli/zap.fli", "sound/zap.voc");
-    static auto launch_anim = Animation("fli/launch.fli");
-    static auto missile_anim = Animation("fli/mslekill.fli");
-    static auto nurse_anim = Animation("fli/bzap.fli", "sound/zap.voc");
-    static auto plane_anim = Animation("fli/launch.fli");
-    static auto rifle_anim = Animation("fli/rflekill.fli", "sound/rifle.voc");
-    static auto snare_anim = Animation("fli/snare.fli");
-    static auto suicide_anim = Animation("fli/suicide.fli");
-    static auto wire_anim = Animation("fli/wirekill.fli", "sound/explode.voc");
-    static auto zombie_anim = Animation("fli/death.fli", "sound/aarh4.voc");
+// each flic is streamed in when it is first needed and released once it has finished
+static Animation &death_anim(const DeathType death_type) {
+    static std::unordered_map<DeathType, Animation> anims = {
+        {DeathType::Acid, Animation("fli/acid.fli")},
+        {DeathType::Bat, Animation("fli/batkill.fli")},
+        {DeathType::Bomb, Animation("fli/isle.fli")},
+        {DeathType::Companion, Animation("fli/zombabe.fli")},
+        {DeathType::Doc, Animation("fli/memkill.fli")},
+        {DeathType::Fence, Animation("fli/zap.fli", "sound/zap.voc")},
+        {DeathType::Launch, Animation("fli/launch.fli")},
+        {DeathType::Missile, Animation("fli/mslekill.fli")},
+        {DeathType::Nurse, Animation("fli/bzap.fli", "sound/zap.voc")},
+        {DeathType::Plane, Animation("fli/launch.fli")},
+        {DeathType::Rifle, Animation("fli/rflekill.fli", "sound/rifle.voc")},
+        {DeathType::Snare, Animation("fli/snare.fli")},
+        {DeathType::Suicide, Animation("fli/suicide.fli")},
+        {DeathType::Wire, Animation("fli/wirekill.fli", "sound/explode.voc")},
+        {DeathType::Zombie, Animation("fli/death.fli", "sound/aarh4.voc")},
+    };
+
+    auto anim = anims.find(death_type);
+
+    if (anim == std::end(anims))
+        anim = anims.find(DeathType::Zombie);
+
+    return anim->second;
+}
 
-    BeginDrawing();
+static Animation &laugh_anim() {
+    static auto anim = Animation("fli/memnabha.fli", "sound/dielaugh.voc");
+    return anim;
+}
+
+static void play_death_anim(Player *player, raylib::Window &window, const int scale) {
+    Screen::BeginFrame();
     {
         window.ClearBackground(raylib::BLACK);
 
-        bool anim_finished = false;
-        switch (death_type) {
-            case DeathType::Acid:
-                anim_finished = acid_anim.play(scale);
-                break;
-            case DeathType::Bat:
-                anim_finished = bat_anim.play(scale);
-                break;
-            case DeathType::Bomb:
-                anim_finished = bomb_anim.play(scale);
-                break;
-            case DeathType::Companion:
-                anim_finished = companion_anim.play(scale);
-                break;
-            case DeathType::Doc:
-                anim_finished = doc_anim.play(scale);
-                break;
-            case DeathType::Fence:
-                anim_finished = fence_anim.play(scale);
-                break;
-            case DeathType::Launch:
-                anim_finished = launch_anim.play(scale);
-                break;
-            case DeathType::Missile:
-                anim_finished = missile_anim.play(scale);
-                break;
-            case DeathType::Nurse:
-                anim_finished = nurse_anim.play(scale);
-                break;
-            case DeathType::Plane:
-                anim_finished = plane_anim.play(scale);
-                break;
-            case DeathType::Rifle:
-                anim_finished = rifle_anim.play(scale);
-                break;
-            case DeathType::Snare:
-                anim_finished = snare_anim.play(scale);
-                break;
-            case DeathType::Suicide:
-                anim_finished = suicide_anim.play(scale);
-                break;
-            case DeathType::Wire:
-                anim_finished = wire_anim.play(scale);
-                break;
-            case DeathType::Zombie:
-            default:
-                anim_finished = zombie_anim.play(scale);
-        }
-
-        if (anim_finished)
+        if (death_anim(player->getDeathType()).play(scale))
             player->setState(State::Laugh);
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 static void play_laugh_anim(Player *player, raylib::Window &window, const int scale) {
-    static auto laugh_anim = Animation("fli/memnabha.fli", "sound/dielaugh.voc");
-
-    BeginDrawing();
+    Screen::BeginFrame();
     {
         window.ClearBackground(raylib::BLACK);
 
-        if (laugh_anim.play(scale)) {
+        if (laugh_anim().play(scale)) {
             World *world = player->getWorld();
             world->setCurrentLevel("maps/01.map");
             auto spawn_point = world->findSpawn();
@@ -252,14 +193,14 @@ static void play_laugh_anim(Player *player, raylib::Window &window, const int sc
             player->respawn(spawn_point);
         }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 static void play_title_anim(Player *player, raylib::Window &window, const int scale, MusicPlayer *music_player) {
     static auto intro_anim = Animation("fli/dead.fli", "sound/laugh.voc");
     music_player->play("music/out3fm.mid");
 
-    BeginDrawing();
+    Screen::BeginFrame();
     {
         window.ClearBackground(raylib::BLACK);
 
@@ -271,7 +212,7 @@ static void play_title_anim(Player *player, raylib::Window &window, const int sc
             player->respawn(spawn_point, true);
         }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 static void play_lab2_anim(Player *player, raylib::Window &window, const int scale, char anim_index) {
@@ -282,7 +223,7 @@ static void play_lab2_anim(Player *player, raylib::Window &window, const int sca
     static auto lab2e_anim = Animation("fli/babee.fli");
     static auto lab2f_anim = Animation("fli/babef.fli");
 
-    BeginDrawing();
+    Screen::BeginFrame();
     {
         window.ClearBackground(raylib::BLACK);
 
@@ -330,7 +271,7 @@ static void play_lab2_anim(Player *player, raylib::Window &window, const int sca
             player->setState(State::Lab2);
         }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 static void play_ending_anim(Player *player, raylib::Window &window, const int scale, int ending_index) {
@@ -338,7 +279,7 @@ static void play_ending_anim(Player *player, raylib::Window &window, const int s
     static auto the_end1_anim = Animation("fli/theend1.fli");
     static auto the_end2_anim = Animation("fli/theend2.fli");
 
-    BeginDrawing();
+    Screen::BeginFrame();
     {
         window.ClearBackground(raylib::BLACK);
 
@@ -359,38 +300,38 @@ static void play_ending_anim(Player *player, raylib::Window &window, const int s
             player->setState(State::Title);
         }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 static void play_doc_transform_anim(Player *player, raylib::Window &window, const int scale) {
     static auto transform_anim = Animation("fli/memgro.fli", "sound/mem1.voc");
 
-    BeginDrawing();
+    Screen::BeginFrame();
     {
         if (transform_anim.play(scale)) {
             player->setState(State::World);
         }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 static void play_doc_die_anim(Player *player, raylib::Window &window, const int scale) {
     static auto die_anim = Animation("fli/membom.fli", "sound/mem6.voc");
 
-    BeginDrawing();
+    Screen::BeginFrame();
     {
         if (die_anim.play(scale)) {
             player->setState(State::World);
             player->setFlag(Flag::BombCountdown);
         }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 static void show_quit(Player *player, raylib::Window &window, const int scale, const State old_state) {
     static auto quit_message = TextureCache::LoadStillCel("stillcel/quit.cel");
 
-    BeginDrawing();
+    Screen::BeginFrame();
     {
         window.ClearBackground(raylib::BLACK);
 
@@ -402,7 +343,7 @@ static void show_quit(Player *player, raylib::Window &window, const int scale, c
             player->setState(old_state);
         }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 static void play_exit_anim(Player *player, raylib::Window &window, const int scale) {
@@ -410,7 +351,7 @@ static void play_exit_anim(Player *player, raylib::Window &window, const int sca
     static auto laugh_anim = Animation("fli/memnabha.fli", "sound/dielaugh.voc");
     static bool play_laugh = false;
 
-    BeginDrawing();
+    Screen::BeginFrame();
     {
         window.ClearBackground(raylib::BLACK);
 
@@ -420,11 +361,12 @@ static void play_exit_anim(Player *player, raylib::Window &window, const int sca
             }
         } else {
             if (laugh_anim.play(scale)) {
+                Capture::Shutdown();
                 exit(0);
             }
         }
     }
-    EndDrawing();
+    Screen::EndFrame();
 }
 
 int main(int argc, char *argv[]) {
@@ -432,7 +374,15 @@ int main(int argc, char *argv[]) {
     argparser.add<std::string>("datadir", 'd', "Data directory", false, "");
     argparser.add<std::string>("map", 'm', "map file", false, "");
     argparser.add<int>("scale", 's', "render scale", false, 0);
+    argparser.add<int>("internal", 'i', "internal render scale, drawn at 320x200 times this and upscaled, 0 renders at window size", false, 0);
     argparser.add<bool>("playback", 'p', "Disable music playback", false, false);
+    argparser.add<bool>("dynamic", 'y', "Adapt the internal render scale to hold the target frame rate", false, false);
+    argparser.add<int>("minscale", 0, "Lowest internal scale for dynamic resolution", false, 1);
+    argparser.add<int>("maxscale", 0, "Highest internal scale for dynamic resolution, 0 for the window scale", false, 0);
+    argparser.add<bool>("minimap", 'n', "Show the automap as an overlay in the 3D view", false, false);
+    argparser.add<float>("drawdistance", 'D', "Maximum draw distance, 0 for the level fog distance", false, 0.0f);
+    argparser.add<bool>("software", 'c', "Raycast the 3D view on the CPU instead of the GPU", false, false);
+    argparser.add<int>("record", 'r', "Record this many frames to a Y4M file from startup, F11 toggles recording and F12 takes a screenshot", false, 0);
     argparser.parse_check(argc, argv);
 
     SetTraceLogLevel(LOG_WARNING);
@@ -440,7 +390,15 @@ int main(int argc, char *argv[]) {
     std::string map_file = argparser.get<std::string>("map");
     std::string datadir = argparser.get<std::string>("datadir");
     int scale = argparser.get<int>("scale");
+    int internal_scale = argparser.get<int>("internal");
     bool disable_music_playback = argparser.get<bool>("playback");
+    bool dynamic = argparser.get<bool>("dynamic");
+    int min_scale = argparser.get<int>("minscale");
+    int max_scale = argparser.get<int>("maxscale");
+    float draw_distance = argparser.get<float>("drawdistance");
+    bool show_minimap = argparser.get<bool>("minimap");
+    bool software_rendering = argparser.get<bool>("software");
+    int record_frames = argparser.get<int>("record");
 
     const std::string title = "Isle of the Dead Remake" + std::string(" (v") + std::string(VERSION) + ")";
 
@@ -465,18 +423,40 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    Capture::SetDirectory(std::filesystem::current_path().string());
     std::filesystem::current_path(datadir);
 
-    SetConfigFlags(FLAG_MSAA_4X_HINT|FLAG_WINDOW_RESIZABLE);
+    internal_scale = std::clamp(internal_scale, 0, scale);
+
+    const int target_fps = 60;
+    std::optional<DynamicResolution> dynamic_resolution;
+
+    if (dynamic) {
+        max_scale = std::clamp(max_scale ? max_scale : scale, 1, scale);
+        min_scale = std::clamp(min_scale, 1, max_scale);
+
+        dynamic_resolution.emplace(min_scale, max_scale, target_fps);
+        internal_scale = max_scale;
+    }
+
+    // the upscaled blit is already pixel exact, MSAA would only cost fill rate
+    if (internal_scale)
+        SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+    else
+        SetConfigFlags(FLAG_MSAA_4X_HINT|FLAG_WINDOW_RESIZABLE);
+
     raylib::Window window(320*scale, 200*scale, title);
-    SetTargetFPS(60);
+    SetTargetFPS(target_fps);
+
+    Screen::SetInternalSize(320*internal_scale, 200*internal_scale);
+
+    // everything below draws in internal pixels
+    int render_scale = internal_scale ? internal_scale : scale;
 
     window.SetExitKey(KEY_NULL);
 
     raylib::AudioDevice audiodevice;
 
-    raylib::Mouse::SetScale(1.0f/scale, 1.0f/scale);
-
     Fnt::ExtractFonts("system.fnt");
     Strings::Extract("iodex1.exe");
     Panel panel;
@@ -517,6 +497,10 @@ int main(int argc, char *argv[]) {
         LevelSettings("maps/31.map", Sky::Day, Ground::Dirt, "music/out4fm.mid"),
     }, "entrance.tbl");
 
+    world.setDrawDistance(draw_distance);
+    world.getAutomap().setOverlay(show_minimap);
+    world.setSoftwareRendering(software_rendering);
+
     Inventory inventory(&panel);
     Help help(&panel);
 
@@ -572,8 +556,36 @@ int main(int argc, char *argv[]) {
         player.setState(State::Title);
     }
 
+    if (record_frames > 0)
+        Capture::StartRecording(record_frames, target_fps);
+
     State old_state = player.getState();
+    State last_state = player.getState();
     while (!window.ShouldClose()) {
+        TextureUpload::Update();
+
+        if (dynamic_resolution) {
+            render_scale = dynamic_resolution->update(GetFrameTime(), Screen::GetBusyTime());
+            Screen::SetInternalSize(320*render_scale, 200*render_scale);
+        }
+
+        if (IsKeyPressed(KEY_F11)) {
+            if (Capture::IsRecording())
+                Capture::StopRecording();
+            else
+                Capture::StartRecording(0, target_fps);
+        }
+
+        if (IsKeyPressed(KEY_F12))
+            Capture::Screenshot();
+
+        if (IsKeyPressed(KEY_F3))
+            world.setShowStats(!world.getShowStats());
+
+        if (IsKeyPressed(KEY_F4)) {
+            std::cout << "Internal resolution " << Screen::GetInternalWidth() << "x" << Screen::GetInternalHeight() << std::endl;
+        }
+
         uint64_t player_input = player.getInput();
 
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
@@ -693,12 +705,12 @@ int main(int argc, char *argv[]) {
         player.setInput(player_input);
 
         if (player.showHelp()) {
-            help.draw(&player, window, scale);
+            help.draw(&player, window, render_scale);
             continue;
         }
 
         if (player.showInventory()) {
-            inventory.draw(&player, scale);
+            inventory.draw(&player, render_scale);
             continue;
         }
 
@@ -709,211 +721,221 @@ int main(int argc, char *argv[]) {
 
         switch (player.getState()) {
             case State::World: 
-                draw_world(&player, &music_player, window, scale);
+                draw_world(&player, &music_player, window, render_scale);
                 break;
 
             case State::CrashedPlaneEntry:
                 music_player.stop();
-                crashed_plane_entry_scene->draw(&player, scale);
+                crashed_plane_entry_scene->draw(&player, render_scale);
                 break;
             case State::CrashedPlaneLeft:
                 music_player.stop();
-                crashed_plane_left_scene->draw(&player, scale);
+                crashed_plane_left_scene->draw(&player, render_scale);
                 break;
             case State::CrashedPlaneCockpit:
                 music_player.stop();
-                crashed_plane_cockpit_scene->draw(&player, scale);
+                crashed_plane_cockpit_scene->draw(&player, render_scale);
                 break;
             case State::CrashedPlaneRight:
                 music_player.stop();
-                crashed_plane_right_scene->draw(&player, scale);
+                crashed_plane_right_scene->draw(&player, render_scale);
                 break;
             case State::CrashedPlaneExit:
                 music_player.stop();
-                crashed_plane_exit_scene->draw(&player, scale);
+                crashed_plane_exit_scene->draw(&player, render_scale);
                 break;
 
             case State::BunkerEntry:
                 music_player.stop();
-                bunker_entry_scene->draw(&player, scale);
+                bunker_entry_scene->draw(&player, render_scale);
                 break;
             case State::BunkerExit:
                 music_player.stop();
-                bunker_exit_scene->draw(&player, scale);
+                bunker_exit_scene->draw(&player, render_scale);
                 break;
             case State::BunkerLeft:
                 music_player.stop();
-                bunker_left_scene->draw(&player, scale);
+                bunker_left_scene->draw(&player, render_scale);
                 break;
             case State::BunkerRight:
-                bunker_right_scene->draw(&player, scale);
+                bunker_right_scene->draw(&player, render_scale);
                 break;
 
             case State::VillageGate1:
                 music_player.stop();
-                village_gate_shaman_scene->draw(&player, scale);
+                village_gate_shaman_scene->draw(&player, render_scale);
                 break;
             case State::VillageGate2:
                 music_player.stop();
-                village_gate_chief_scene->draw(&player, scale);
+                village_gate_chief_scene->draw(&player, render_scale);
                 break;
 
             case State::Village1EyesLU:
                 music_player.stop();
-                village1_eyes_lu_scene->draw(&player, scale);
+                village1_eyes_lu_scene->draw(&player, render_scale);
                 break;
             case State::Toilet:
                 music_player.stop();
-                toilet_scene->draw(&player, scale);
+                toilet_scene->draw(&player, render_scale);
                 break;
             case State::Village1EyesLD:
                 music_player.stop();
-                village1_eyes_ld_scene->draw(&player, scale);
+                village1_eyes_ld_scene->draw(&player, render_scale);
                 break;
             case State::Village1EyesRU:
                 music_player.stop();
-                village1_eyes_ru_scene->draw(&player, scale);
+                village1_eyes_ru_scene->draw(&player, render_scale);
                 break;
             case State::Village1EyesR:
                 music_player.stop();
-                village1_eyes_r_scene->draw(&player, scale);
+                village1_eyes_r_scene->draw(&player, render_scale);
                 break;
             case State::Village1EyesRD:
                 music_player.stop();
-                village1_eyes_rd_scene->draw(&player, scale);
+                village1_eyes_rd_scene->draw(&player, render_scale);
                 break;
 
             case State::Village2EyesLU:
                 music_player.stop();
-                village2_eyes_lu_scene->draw(&player, scale);
+                village2_eyes_lu_scene->draw(&player, render_scale);
                 break;
             case State::Village2EyesL:
                 music_player.stop();
-                village2_eyes_l_scene->draw(&player, scale);
+                village2_eyes_l_scene->draw(&player, render_scale);
                 break;
             case State::Shower:
                 music_player.stop();
-                shower_scene->draw(&player, scale);
+                shower_scene->draw(&player, render_scale);
                 break;
             case State::Village2EyesRU:
                 music_player.stop();
-                village2_eyes_ru_scene->draw(&player, scale);
+                village2_eyes_ru_scene->draw(&player, render_scale);
                 break;
             case State::Developers:
                 music_player.stop();
-                developers_scene->draw(&player, scale);
+                developers_scene->draw(&player, render_scale);
                 break;
             case State::Village2EyesRD:
                 music_player.stop();
-                village2_eyes_rd_scene->draw(&player, scale);
+                village2_eyes_rd_scene->draw(&player, render_scale);
                 break;
 
             case State::Shaman:
                 music_player.stop();
-                shaman_scene->draw(&player, scale);
+                shaman_scene->draw(&player, render_scale);
                 break;
             case State::Chief:
                 music_player.stop();
-                chief_scene->draw(&player, scale);
+                chief_scene->draw(&player, render_scale);
                 break;
 
             case State::TempleEntrance:
                 music_player.stop();
-                temple_entrance_scene->draw(&player, scale);
+                temple_entrance_scene->draw(&player, render_scale);
                 break;
             case State::Oracle:
                 music_player.stop();
-                oracle_scene->draw(&player, scale);
+                oracle_scene->draw(&player, render_scale);
                 break;
 
             case State::RocketLauncher:
                 music_player.stop();
-                rocket_launcher_scene->draw(&player, scale);
+                rocket_launcher_scene->draw(&player, render_scale);
                 break;
             case State::PlaneCockpit:
                 music_player.stop();
-                plane_cockpit_scene->draw(&player, scale);
+                plane_cockpit_scene->draw(&player, render_scale);
                 break;
             case State::PlaneGalley:
                 music_player.stop();
-                plane_galley_scene->draw(&player, scale);
+                plane_galley_scene->draw(&player, render_scale);
                 break;
 
             case State::Lab1:
                 music_player.stop();
-                lab_zombie_scene->draw(&player, scale);
+                lab_zombie_scene->draw(&player, render_scale);
                 break;
             case State::Lab2:
                 music_player.stop();
-                lab_companion_scene->draw(&player, scale);
+                lab_companion_scene->draw(&player, render_scale);
                 break;
             case State::Mirror:
                 music_player.stop();
-                mirror_scene->draw(&player, scale);
+                mirror_scene->draw(&player, render_scale);
                 break;
 
             case State::Lab2A:
-                play_lab2_anim(&player, window, scale, 'A');
+                play_lab2_anim(&player, window, render_scale, 'A');
                 break;
             case State::Lab2B:
-                play_lab2_anim(&player, window, scale, 'B');
+                play_lab2_anim(&player, window, render_scale, 'B');
                 break;
             case State::Lab2C:
-                play_lab2_anim(&player, window, scale, 'C');
+                play_lab2_anim(&player, window, render_scale, 'C');
                 break;
             case State::Lab2D:
-                play_lab2_anim(&player, window, scale, 'D');
+                play_lab2_anim(&player, window, render_scale, 'D');
                 break;
             case State::Lab2E:
-                play_lab2_anim(&player, window, scale, 'E');
+                play_lab2_anim(&player, window, render_scale, 'E');
                 break;
             case State::Lab2F:
-                play_lab2_anim(&player, window, scale, 'F');
+                play_lab2_anim(&player, window, render_scale, 'F');
                 break;
 
             case State::DocTransform:
-                play_doc_transform_anim(&player, window, scale);
+                play_doc_transform_anim(&player, window, render_scale);
                 break;
 
             case State::DocDie:
-                play_doc_die_anim(&player, window, scale);
+                play_doc_die_anim(&player, window, render_scale);
                 break;
 
             case State::Title:
-                play_title_anim(&player, window, scale, &music_player);
+                play_title_anim(&player, window, render_scale, &music_player);
                 break;
             case State::Dead:
-                play_death_anim(&player, window, scale);
+                play_death_anim(&player, window, render_scale);
                 break;
             case State::Laugh:
-                play_laugh_anim(&player, window, scale);
+                play_laugh_anim(&player, window, render_scale);
                 break;
 
             case State::Quit:
-                show_quit(&player, window, scale, old_state);
+                show_quit(&player, window, render_scale, old_state);
                 break;
             case State::Exit:
-                play_exit_anim(&player, window, scale);
+                play_exit_anim(&player, window, render_scale);
                 break;
 
             case State::Ending:
                 music_player.play("music/out1fm.mid");
-                play_ending_anim(&player, window, scale, 0);
+                play_ending_anim(&player, window, render_scale, 0);
                 break;
             case State::Ending1:
                 music_player.play("music/out1fm.mid");
-                play_ending_anim(&player, window, scale, 1);
+                play_ending_anim(&player, window, render_scale, 1);
                 break;
             case State::Ending2:
                 music_player.play("music/out1fm.mid");
-                play_ending_anim(&player, window, scale, 2);
+                play_ending_anim(&player, window, render_scale, 2);
                 break;
 
             case State::Map:
-                draw_map(&player, window, scale);
+                draw_map(&player, window, render_scale);
                 break;
         }
+
+        // request the death flic on the frame the player dies, the laugh decodes while it plays
+        if (player.getState() == State::Dead && last_state != State::Dead) {
+            death_anim(player.getDeathType()).load();
+            laugh_anim().load();
+        }
+
+        last_state = player.getState();
     }
 
+    Capture::Shutdown();
+
     exit (0);
 }
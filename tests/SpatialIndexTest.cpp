@@ -0,0 +1,171 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+#include "Map.h"
+#include "Entity.h"
+#include "Monster.h"
+#include "RayPacket.h"
+#include "SpatialIndex.h"
+
+static int failures = 0;
+
+static void check(bool passed, const std::string &name) {
+    std::cout << (passed ? "PASS " : "FAIL ") << name << std::endl;
+
+    if (!passed)
+        failures++;
+}
+
+// a standing monster that counts the damage dealt to it instead of getting hurt, so it never stops blocking
+class Target : public Monster::Base {
+    int taken = 0;
+public:
+    Target(const Segment *segment, const std::vector<CelHandle> &textures) : Base(segment, textures, 0.0f, DeathType::Zombie, 0, 0.0f, 0.0f, 0.0f) {
+        state = Monster::MonsterState::Standing;
+    }
+
+    void damage(Player *player, const DamageType damage_type, int amount) {
+        taken += amount;
+    }
+
+    int takeDamage() {
+        return std::exchange(taken, 0);
+    }
+};
+
+// a body left lying to be picked up, like a dead Doc
+class Body : public Target {
+public:
+    Body(const Segment *segment, const std::vector<CelHandle> &textures) : Target(segment, textures) {
+    }
+
+    Collision collide() const {
+        return Collision::Touch;
+    }
+};
+
+// the header record, a door across x = 50 and a monster centred on (80, 40) behind it
+static std::string write_map() {
+    const uint16_t records[3][5] = {
+        {3, 0, 0, 0, 0},
+        {0, 50, 30, 50, 50},
+        {0, 76, 40, 84, 40},
+    };
+
+    auto filename = (std::filesystem::temp_directory_path() / "spatial_index_test.map").string();
+    std::ofstream fh(filename, std::ios::binary|std::ios::out);
+
+    for (const auto &record : records) {
+        // every field is followed by a flags word, the footer closes the record
+        uint16_t fields[12] = {record[0], 0, record[1], 0, record[2], 0, record[3], 0, record[4], 0, 0, 0};
+        fh.write((const char *)fields, sizeof(fields));
+    }
+
+    return filename;
+}
+
+static const raylib::Ray aim(raylib::Vector3(10.0f, 6.0f, 40.0f), raylib::Vector3(1.0f, 0.0f, 0.0f));
+
+// what the rifle does, the nearest hit takes the shot
+static void shoot(const SpatialIndex &index) {
+    auto hits = index.castRay(aim, 1000);
+
+    if (!hits.empty())
+        hits.front().entity->damage(nullptr, DamageType::Bullet, 20);
+}
+
+// what the shotgun does, every pellet lands on the nearest hit of its ray
+static void blast(const SpatialIndex &index) {
+    for (const auto &hit : index.castPacket(RayPacket(aim, 12, 4.0f), 1000)) {
+        if (hit)
+            hit->entity->damage(nullptr, DamageType::Bullet, 1);
+    }
+}
+
+int main() {
+    Map map(write_map());
+    const auto &segments = map.getSegments();
+
+    const std::vector<CelHandle> textures(2);
+    const Entrance entrance("maps/01.map", 0, 0, 0);
+
+    {
+        ClosedDoor door(&segments[1], textures, 1, entrance);
+        Target monster(&segments[2], textures);
+        SpatialIndex index(map, {SpatialIndex::Entry(1, &door), SpatialIndex::Entry(2, &monster)});
+
+        shoot(index);
+        blast(index);
+        check(monster.takeDamage() == 0, "closed door stops the shot and the pellets");
+
+        // the opening plays from its first frame, two frames at one per tick
+        door.use(nullptr, std::nullopt);
+        door.update(nullptr, 1);
+        door.update(nullptr, 2);
+        index.update();
+
+        shoot(index);
+        check(monster.takeDamage() == 20, "monster behind an opened door takes the shot");
+
+        blast(index);
+        check(monster.takeDamage() > 0, "monster behind an opened door takes the pellets");
+    }
+
+    {
+        Barricade barricade(&segments[1], textures[0], textures[1], entrance, DamageType::Machete);
+        Target monster(&segments[2], textures);
+        SpatialIndex index(map, {SpatialIndex::Entry(1, &barricade), SpatialIndex::Entry(2, &monster)});
+
+        shoot(index);
+        blast(index);
+        check(monster.takeDamage() == 0, "barricade stops the shot and the pellets");
+
+        barricade.damage(nullptr, DamageType::Machete, 1);
+        index.update();
+
+        shoot(index);
+        check(monster.takeDamage() == 20, "monster behind a broken barricade takes the shot");
+
+        blast(index);
+        check(monster.takeDamage() > 0, "monster behind a broken barricade takes the pellets");
+    }
+
+    {
+        Body body(&segments[1], textures);
+        Target monster(&segments[2], textures);
+        SpatialIndex index(map, {SpatialIndex::Entry(1, &body), SpatialIndex::Entry(2, &monster)});
+
+        shoot(index);
+        check(monster.takeDamage() == 20, "monster behind a body takes the shot");
+
+        blast(index);
+        check(monster.takeDamage() > 0, "monster behind a body takes the pellets");
+    }
+
+    return failures ? 1 : 0;
+}